@@ -26,345 +26,485 @@
 #include <typeinfo>
 #include <cassert>
 #include <cstdio>
+#include <pthread.h>
 
 namespace moe
 {
   ////////////////////////////////////////////////////////////////////////
+  // a bit vector wider than 64 bits, kept in a fixed count of 32 bit
+  // words. the count is known at compile time, so the loops unroll.
   template <uint32_t T>
   class UIntN
   {
-    uint32_t* _v;
   public:
-    uint32_t* v() const { return _v; }
-    uint32_t  n() const { return T; }
+    enum { N =(T+31)/32 };
+  private:
+    uint32_t _v[N];
     
-    virtual ~UIntN(){}
-    UIntN():
-      _v(NULL)
-    {}
-    UIntN(uint32_t* a):
-      _v(a)
-    {}
-    UIntN(uint32_t& a)
+    void trim()
     {
-      _v =&a;
+      if( (T%32)!=0 )
+	_v[N-1] &=~(0xFFFFFFFFUL<<(T%32));
     }
-    UIntN(uint64_t& a)
+  public:
+    uint32_t*       v()       { return _v; }
+    const uint32_t* v() const { return _v; }
+    uint32_t        n() const { return T; }
+    
+    UIntN()
     {
-      _v =(uint32_t*)&a;
+      uint32_t i;
+      for( i=0;i<N;i++ )
+	_v[i] =0;
     }
-    UIntN(UIntN& a)
+    UIntN(uint64_t a)
     {
-      _v =a.v();
+      uint32_t i;
+      for( i=0;i<N;i++ )
+	_v[i] =(i<2) ? uint32_t(a>>(32*i)) : 0;
+      trim();
     }
-    
-    UIntN& operator =(const UIntN& a)
+    template <uint32_t B>
+    explicit UIntN(const UIntN<B>& a)
     {
-      memcpy(_v,a.v(),((T+31)/32)*4);
+      uint32_t i;
+      for( i=0;i<N;i++ )
+	_v[i] =(i<UIntN<B>::N) ? a.v()[i] : 0;
+      trim();
     }
+    ~UIntN(){}
     
-    friend std::ostream& operator << (std::ostream& ostr,const UIntN& a)
+    // constants are built a word at a time, UIntN<96>().word(2,1)
+    UIntN& word(uint32_t i,uint32_t w)
     {
-      int i;
-      for( i=a.n()-1;i>=0;i-- )
-	ostr << ((a._v[i/32]>>(i%32))&1);
-      return ostr;
+      _v[i] =w;
+      trim();
+      return *this;
+    }
+    uint64_t low() const
+    {
+      return (N>1) ? ((uint64_t(_v[1])<<32)|_v[0]) : _v[0];
+    }
+    bool any() const
+    {
+      uint32_t t=0;
+      uint32_t i;
+      for( i=0;i<N;i++ )
+	t |=_v[i];
+      return (t!=0);
+    }
+    bool bit(uint32_t i) const
+    {
+      return (i<T) ? ((_v[i>>5]>>(i&31))&1) : false;
     }
-  };
-   /*** 
-  template <uint32_t T,uint32_t A,uint32_t B>
-  UIntN<T> operator +(const UIntN<A>& a,const UIntN<B>& b)
-  {
-    uint32_t tv[(T+31)/32];
-    uint64_t t=0,tw=0;
-    int i;
-    for( i=0;i<(tw+31)/32;i++ )
-      tv[i] =t =
-	uint64_t( ((i*32)<aw)?av[i]:0 )+
-	uint64_t( ((i*32)<bw)?bv[i]:0 )+(t>>32);
-    if( (tw%32)!=0 )
-      tv[(tw-1)/32] &=(~(0xffffffff<<(tw%32)));
     
-    return UIntN<T>(tv);
-  }
-
-
-
-  friend UIntN operator -(const UIntN& a,const UIntN& b)
+    ////////////////////////////////////
+    friend UIntN operator +(const UIntN& a,const UIntN& b)
+    {
+      UIntN r;
+      uint64_t t=0;
+      uint32_t i;
+      for( i=0;i<N;i++ )
+	r._v[i] =t =uint64_t(a._v[i])+uint64_t(b._v[i])+(t>>32);
+      r.trim();
+      return r;
+    }
+    friend UIntN operator -(const UIntN& a,const UIntN& b)
     {
       UIntN r;
       uint64_t t=0;
-      unsigned int i;
-      for( i=0;i<(T+31)/32;i++ )
+      uint32_t i;
+      for( i=0;i<N;i++ )
 	r._v[i] =t =uint64_t(a._v[i])-uint64_t(b._v[i])-((t>>32)&1);
+      r.trim();
       return r;
     }
+    friend UIntN operator -(const UIntN& a)
+    {
+      return UIntN()-a;
+    }
+    friend UIntN operator *(const UIntN& a,const UIntN& b)
+    {
+      UIntN r;
+      uint32_t i,j;
+      for( i=0;i<N;i++ )
+	{
+	  uint64_t t=0;
+	  for( j=0;(i+j)<N;j++ )
+	    {
+	      t +=uint64_t(a._v[i])*uint64_t(b._v[j])+r._v[i+j];
+	      r._v[i+j] =t;
+	      t >>=32;
+	    }
+	}
+      r.trim();
+      return r;
+    }
+    // restoring division, a division by zero leaves zero.
+    static void divide(const UIntN& a,const UIntN& b,UIntN& q,UIntN& m)
+    {
+      q =UIntN();
+      m =UIntN();
+      if( !b.any() )
+	return;
+      int i;
+      for( i=T-1;i>=0;i-- )
+	{
+	  bool carry =m.bit(T-1);
+	  m =(m<<1);
+	  m._v[0] |=a.bit(i);
+	  if( carry||(m>=b) )
+	    {
+	      m =m-b;
+	      q._v[i>>5] |=(1UL<<(i&31));
+	    }
+	}
+    }
+    friend UIntN operator /(const UIntN& a,const UIntN& b)
+    {
+      UIntN q,m;
+      divide(a,b,q,m);
+      return q;
+    }
+    friend UIntN operator %(const UIntN& a,const UIntN& b)
+    {
+      UIntN q,m;
+      divide(a,b,q,m);
+      return m;
+    }
     friend UIntN operator &(const UIntN& a,const UIntN& b)
     {
       UIntN r;
-      unsigned int i;
-      for( i=0;i<(T+31)/32;i++ )
+      uint32_t i;
+      for( i=0;i<N;i++ )
 	r._v[i] =a._v[i]&b._v[i];
       return r;
     }
     friend UIntN operator |(const UIntN& a,const UIntN& b)
     {
       UIntN r;
-      unsigned int i;
-      for( i=0;i<(T+31)/32;i++ )
+      uint32_t i;
+      for( i=0;i<N;i++ )
 	r._v[i] =a._v[i]|b._v[i];
       return r;
     }
     friend UIntN operator ^(const UIntN& a,const UIntN& b)
     {
       UIntN r;
-      unsigned int i;
-      for( i=0;i<(T+31)/32;i++ )
+      uint32_t i;
+      for( i=0;i<N;i++ )
 	r._v[i] =a._v[i]^b._v[i];
       return r;
     }
     friend UIntN operator ~(const UIntN& a)
     {
       UIntN r;
-      unsigned int i;
-      for( i=0;i<(T+31)/32;i++ )
+      uint32_t i;
+      for( i=0;i<N;i++ )
 	r._v[i] =~a._v[i];
+      r.trim();
       return r;
     }
-    friend UIntN operator >>(const UIntN& a,const uint32_t b)
+    friend UIntN operator >>(const UIntN& a,uint32_t b)
     {
       UIntN r;
       uint32_t c=b>>5;
       uint32_t d=b&31;
-      uint32_t e=32-d;
-      unsigned int i;
-      if( d==0 )
-	for( i=0;i<(T+31)/32;i++ )
-	  r._v[i]  =((i+c+0) < T) ? a._v[i+c] : 0;
-      else
-	for( i=0;i<(T+31)/32;i++ )
-	  {
-	    r._v[i]  =((i+c+0) < T) ? (a._v[i+c]>>d) : 0;
-	    r._v[i] |=((i+c+1) < T) ? (a._v[i+c+1]<<e) : 0;
-	  }
+      uint32_t i;
+      if( b>=T )
+	return r;
+      for( i=0;(i+c)<N;i++ )
+	{
+	  r._v[i] =a._v[i+c]>>d;
+	  if( (d!=0)&&((i+c+1)<N) )
+	    r._v[i] |=a._v[i+c+1]<<(32-d);
+	}
       return r;
     }
-    friend UIntN operator <<(const UIntN& a,const uint32_t b)
+    friend UIntN operator <<(const UIntN& a,uint32_t b)
     {
       UIntN r;
       uint32_t c=b>>5;
       uint32_t d=b&31;
-      uint32_t e=32-d;
-      int i;
-      if( d==0 )
-	for( i=0;i<(T+31)/32;i++ )
-	  r._v[i]  =((i-c-0) >=0) ? a._v[i-c-0] : 0;
-      else    
-	for( i=0;i<(T+31)/32;i++ )
-	  {
-	    r._v[i]  =((i-c-0) >=0) ? (a._v[i-c-0]<<d) : 0;
-	    r._v[i] |=((i-c-1) >=0) ? (a._v[i-c-1]>>e) : 0;
-	  }
+      uint32_t i;
+      if( b>=T )
+	return r;
+      for( i=c;i<N;i++ )
+	{
+	  r._v[i] =a._v[i-c]<<d;
+	  if( (d!=0)&&(i>c) )
+	    r._v[i] |=a._v[i-c-1]>>(32-d);
+	}
+      r.trim();
       return r;
     }
+    UIntN& operator >>=(uint32_t b)
+    {
+      return (*this =(*this>>b));
+    }
+    UIntN& operator <<=(uint32_t b)
+    {
+      return (*this =(*this<<b));
+    }
+    
+    ////////////////////////////////////
     friend bool operator ==(const UIntN& a,const UIntN& b)
     {
-      unsigned int i;
-      for( i=0;i<(T+31)/32;i++ )
+      uint32_t i;
+      for( i=0;i<N;i++ )
 	if( a._v[i]!=b._v[i] )
 	  return false;
       return true;
     }
     friend bool operator !=(const UIntN& a,const UIntN& b)
     {
-      unsigned int i;
-      for( i=0;i<(T+31)/32;i++ )
-	if( a._v[i]!=b._v[i] )
-	  return true;
-      return false;
+      return !(a==b);
     }
     friend bool operator <(const UIntN& a,const UIntN& b)
     {
       int i;
-      for( i=((T+31)/32)-1;i>=0;i-- )
-	if( a._v[i]<b._v[i] )
-	  return true;
-	else  if( a._v[i]>b._v[i] )
-	  return false;
+      for( i=N-1;i>=0;i-- )
+	if( a._v[i]!=b._v[i] )
+	  return (a._v[i]<b._v[i]);
       return false;
     }
     friend bool operator >(const UIntN& a,const UIntN& b)
     {
-      int i;
-      for( i=((T+31)/32)-1;i>=0;i-- )
-	if( a._v[i]>b._v[i] )
-	  return true;
-	else  if( a._v[i]<b._v[i] )
-	  return false;
-      return false;
+      return (b<a);
     }
     friend bool operator <=(const UIntN& a,const UIntN& b)
     {
-      int i;
-      for( i=((T+31)/32)-1;i>=0;i-- )
-	if( a._v[i]<b._v[i] )
-	  return true;
-	else  if( a._v[i]>b._v[i] )
-	  return false;
-      return false;
+      return !(b<a);
     }
     friend bool operator >=(const UIntN& a,const UIntN& b)
+    {
+      return !(a<b);
+    }
+    
+    friend std::ostream& operator << (std::ostream& ostr,const UIntN& a)
     {
       int i;
-      for( i=((T+31)/32)-1;i>=0;i-- )
-	if( a._v[i]>b._v[i] )
-	  return true;
-	else  if( a._v[i]<b._v[i] )
-	  return false;
-      return false;
+      for( i=a.n()-1;i>=0;i-- )
+	ostr << a.bit(i);
+      return ostr;
     }
-
-
-    friend bool case_equality(const UIntN& a,const UIntN& b,const UIntN& m)
+  };
+  
+  ////////////////////////////////////////////////////////////////////////
+  // a memory of D words of class T, a page of 2^P words allocated at its
+  // first write. the pages never written read from one shared zero page,
+  // so a large memory costs its page table until it is used.
+  template <typename T,uint32_t D,uint32_t P =12>
+  class Sparse
+  {
+    enum { S =1U<<P, L =(D+S-1)>>P };
+    T* _p[L];
+    
+    static T* zero()
     {
-      unsigned int i;
-      for( i=0;i<(T+31)/32;i++ )
-	if( (a._v[i]&m._v[i])!=(b._v[i]&m._v[i]) )
-	  return false;
-      return true;
+      static T page[S];
+      return page;
     }
-    friend bool case_inequality(const UIntN& a,const UIntN& b,const UIntN& m)
+    void copy(const Sparse& a)
     {
-      unsigned int i;
-      for( i=0;i<(T+31)/32;i++ )
-	if( (a._v[i]&m._v[i])!=(b._v[i]&m._v[i]) )
-	  return true;
-      return false;
+      uint32_t i,j;
+      for( i=0;i<L;i++ )
+	if( a._p[i]==zero() )
+	  _p[i] =zero();
+	else
+	  {
+	    _p[i] =new T[S];
+	    for( j=0;j<S;j++ )
+	      _p[i][j] =a._p[i][j];
+	  }
     }
-    friend bool reduction_and(const UIntN& a)
+    void clear()
     {
-      uint32_t t=0xFFFFFFFF;
-      unsigned int i;
-      for( i=0;i<(T+31)/32;i++ )
-	t &=a.v[i];
-      return (t==0xFFFFFFFF);
+      uint32_t i;
+      for( i=0;i<L;i++ )
+	if( _p[i]!=zero() )
+	  delete [] _p[i];
     }
-    friend bool reduction_nand(const UIntN& a)
+  public:
+    Sparse()
     {
-      uint32_t t=0xFFFFFFFF;
-      unsigned int i;
-      for( i=0;i<(T+31)/32;i++ )
-	t &=a.v[i];
-      return !(t==0xFFFFFFFF);
+      uint32_t i;
+      for( i=0;i<L;i++ )
+	_p[i] =zero();
     }
-    friend bool reduction_or(const UIntN& a)
+    Sparse(const Sparse& a)
     {
-      uint32_t t=0;
-      unsigned int i;
-      for( i=0;i<(T+31)/32;i++ )
-	t |=a.v[i];
-      return (t!=0);
+      copy(a);
     }
-    friend bool reduction_nor(const UIntN& a)
+    ~Sparse()
     {
-      uint32_t t=0;
-      unsigned int i;
-      for( i=0;i<(T+31)/32;i++ )
-	t |=a.v[i];
-      return !(t!=0);
+      clear();
     }
-    friend bool reduction_xor(const UIntN& a)
+    Sparse& operator = (const Sparse& a)
     {
-      uint32_t t=0;
-      unsigned int i;
-      for( i=0;i<(T+31)/32;i++ )
-	t ^=a.v[i];
-      t ^=(t>>16);
-      t ^=(t>>8);
-      t ^=(t>>4);
-      t ^=(t>>2);
-      t ^=(t>>1);    
-      return (t&1);
+      if( this!=&a )
+	{
+	  clear();
+	  copy(a);
+	}
+      return *this;
+    }
+    
+    // the word at an address below D
+    const T& read(uint32_t a) const
+    {
+      return _p[a>>P][a&(S-1)];
     }
-    friend bool reduction_nxor(const UIntN& a)
+    T& write(uint32_t a)
+    {
+      T*& p =_p[a>>P];
+      if( p==zero() )
+	p =new T[S]();
+      return p[a&(S-1)];
+    }
+    // the pages written so far
+    uint32_t pages() const
+    {
+      uint32_t i,n =0;
+      for( i=0;i<L;i++ )
+	n +=(_p[i]!=zero());
+      return n;
+    }
+  };
+  
+  ////////////////////////////////////////////////////////////////////////
+  // helper functions
+  class EmVer
+  {
+  public:
+    EmVer(){}
+    virtual ~EmVer(){}
+    ////////////////////////////////////
+    // wide bit vectors
+    template <uint32_t T>
+    static bool Index(const UIntN<T>& a,uint32_t i)
+    {
+      return a.bit(i);
+    }
+    template <uint32_t W,uint32_t T>
+    static UIntN<W> Part(const UIntN<T>& a,uint32_t l)
+    {
+      return UIntN<W>(a>>l);
+    }
+    // a part of at most 64 bits at an offset known at run time : reads
+    // the two or three words it spans, 0 past the vector
+    template <uint32_t T>
+    static uint64_t Select(const UIntN<T>& a,uint32_t l,uint64_t m)
+    {
+      const uint32_t w =l>>5;
+      const uint32_t s =l&31;
+      uint64_t r =0;
+      if( w<UIntN<T>::N )
+	r =a.v()[w];
+      if( w+1<UIntN<T>::N )
+	r |=uint64_t(a.v()[w+1])<<32;
+      r >>=s;
+      if( (s!=0)&&(w+2<UIntN<T>::N) )
+	r |=uint64_t(a.v()[w+2])<<(64-s);
+      return r&m;
+    }
+    template <uint32_t T>
+    static UIntN<T> Concat(const UIntN<T>& l,const UIntN<T>& r,uint32_t rw)
+    {
+      return (l<<rw)|r;
+    }
+    template <uint32_t T>
+    static UIntN<T> Repeat(uint32_t repeat,const UIntN<T>& concat,uint32_t concat_width)
+    {
+      UIntN<T> r =concat;
+      uint32_t i;
+      for( i=1;i<repeat;i++ )
+	r =(r<<concat_width)|concat;
+      return r;
+    }
+    template <uint32_t T>
+    static void Assign(UIntN<T>& a,uint32_t msb,uint32_t lsb,const UIntN<T>& b)
+    {
+      UIntN<T> m =(~UIntN<T>())>>(T-(msb-lsb+1));
+      a =(a&~(m<<lsb))|((b&m)<<lsb);
+    }
+    template <uint32_t T,uint32_t B>
+    static void Assign(UIntN<T>& a,uint32_t msb,uint32_t lsb,const UIntN<B>& b)
+    {
+      Assign(a,msb,lsb,UIntN<T>(b));
+    }
+    template <uint32_t T>
+    static void Assign(UIntN<T>& a,uint32_t msb,uint32_t lsb,uint64_t b)
+    {
+      Assign(a,msb,lsb,UIntN<T>(b));
+    }
+    template <uint32_t T>
+    static UIntN<T> SignExt(const UIntN<T>& a,uint32_t msb)
+    {
+      if( a.bit(msb) )
+	return a|((~UIntN<T>())<<msb);
+      else
+	return a;
+    }
+    template <uint32_t T>
+    static bool ReductionAND(const UIntN<T>& a)
+    {
+      return (a==~UIntN<T>());
+    }
+    template <uint32_t T>
+    static bool ReductionOR(const UIntN<T>& a)
+    {
+      return a.any();
+    }
+    template <uint32_t T>
+    static bool ReductionXOR(const UIntN<T>& a)
     {
       uint32_t t=0;
-      unsigned int i;
-      for( i=0;i<(T+31)/32;i++ )
-	t ^=a.v[i];
+      uint32_t i;
+      for( i=0;i<UIntN<T>::N;i++ )
+	t ^=a.v()[i];
       t ^=(t>>16);
       t ^=(t>>8);
       t ^=(t>>4);
       t ^=(t>>2);
-      t ^=(t>>1);    
-      return !(t&1);
+      t ^=(t>>1);
+      return (t&1);
     }
-    bool index(uint32_t i)
+    template <uint32_t T>
+    static bool ReductionNAND(const UIntN<T>& a)
     {
-      uint32_t c=i>>5;
-      uint32_t d=i&31;
-      return (_v[c]>>d)&1;
+      return !ReductionAND(a);
     }
-    friend UIntN Mask(unsigned int w)
+    template <uint32_t T>
+    static bool ReductionNOR(const UIntN<T>& a)
     {
-      UIntN r;
-      unsigned int i;
-      for( i=0;i<(w+31)/32;i++ )
-        r._v[i] =0xFFFFFFFF;
-      r._v[i-1] =~(0xFFFFFFFF<<(w&31));
-      return r;
+      return !a.any();
     }
-    friend UIntN Mask(unsigned int msb,unsigned int lsb)
+    template <uint32_t T>
+    static bool ReductionNXOR(const UIntN<T>& a)
     {
-      UIntN r;
-      unsigned int i;
-
-      return r;
+      return !ReductionXOR(a);
     }
-
-
-    UIntN operator ()(uint32_t m,uint32_t l) const //read
+    template <uint32_t T>
+    static bool CaseEquality(const UIntN<T>& a,const UIntN<T>& b,const UIntN<T>& m)
     {
+      return ((a&m)==(b&m));
     }
-    _UIntN operator ()(uint32_t m,uint32_t l) //write
+    template <uint32_t T>
+    static bool CaseInequality(const UIntN<T>& a,const UIntN<T>& b,const UIntN<T>& m)
     {
+      return ((a&m)!=(b&m));
     }
-    UIntN part(uint32_t m,uint32_t l)
+    template <uint32_t T>
+    static void vcd_dump(std::FILE* fp,const UIntN<T>& d,int w)
     {
-      UIntN r;
-      uint32_t lc =l>>5;
-      uint32_t lb =l&31;
-      uint32_t ld =32-lb;
-      uint32_t mc =(m-l+1+31)>>5;
-      uint32_t mm =31-(m-l+1+31)&31;
-      
-      unsigned int i;
-      if( lb==0 )
-	for( i=0;i<mc;i++ )
-	  r._v[i]  =((i+lc+0) < T) ? _v[i+lc] : 0;
-      else
-	for( i=0;i<mc;i++ )
-	  {
-	    r._v[i]  =((i+lc+0) < T) ? (_v[i+lc+0]>>lb) : 0;
-	    r._v[i] |=((i+lc+1) < T) ? (_v[i+lc+1]<<ld) : 0;
-	  }
-      r._v[mc-1] &=(0xFFFFFFFFUL>>mm);
-      for( ;i<T;i++ )
-	r._v[i] =0;
-      return r;
+      fputc('b',fp);
+      int i;
+      for( i=w-1;i>=0;i-- )
+	fputc(d.bit(i) ? '1' : '0',fp);
     }
-  };
-  ***/  
-  
-  ////////////////////////////////////////////////////////////////////////
-  // helper functions
-  class EmVer
-  {
-  public:
-    EmVer(){}
-    virtual ~EmVer(){}
     ////////////////////////////////////
-    inline uint32_t* Bucket(uint32_t* tv,uint32_t tw,
+    static inline uint32_t* Bucket(uint32_t* tv,uint32_t tw,
 			    uint32_t r)
     {
       tv[0] =r;
@@ -373,7 +513,7 @@ namespace moe
 	tv[i] =0;
       return tv;
     }
-    inline uint32_t* Bucket(uint32_t* tv,uint32_t tw,
+    static inline uint32_t* Bucket(uint32_t* tv,uint32_t tw,
 			    uint64_t r)
     {
       tv[0] =r;
@@ -383,7 +523,7 @@ namespace moe
 	tv[i] =0;
       return tv;
     }
-    inline uint32_t* Bucket(uint32_t* tv,uint32_t tw,
+    static inline uint32_t* Bucket(uint32_t* tv,uint32_t tw,
 			    uint32_t* rv,uint32_t rw)
     {
       int i;
@@ -392,7 +532,7 @@ namespace moe
       return tv;
     }
     ////////////////////////////////////
-    inline void Assign(uint32_t* av,uint32_t msb,uint32_t lsb,
+    static inline void Assign(uint32_t* av,uint32_t msb,uint32_t lsb,
 		       uint32_t* bv,uint32_t bw)
     {
       int ai =lsb/32;
@@ -415,7 +555,7 @@ namespace moe
 	      ));
 	}
 	}
-    inline void Assign(uint32_t* av,uint32_t aw,
+    static inline void Assign(uint32_t* av,uint32_t aw,
 		       uint32_t* bv,uint32_t bw)
     {
       int i;
@@ -425,35 +565,71 @@ namespace moe
       if( (aw%32)!=0 )
       av[(aw-1)/32] &=(~(0xffffffff<<(aw%32)));
     }
-    inline void Assign(uint64_t& a,uint64_t mask,uint32_t lsb,uint64_t b)
+    static inline void Assign(uint64_t& a,uint64_t mask,uint32_t lsb,uint64_t b)
     {
       a =(a&(~mask))|((b<<lsb)&mask);
     }
-    inline void Assign(uint32_t& a,uint32_t mask,uint32_t lsb,uint32_t b)
+    static inline void Assign(uint32_t& a,uint32_t mask,uint32_t lsb,uint32_t b)
     {
       a =(a&(~mask))|((b<<lsb)&mask);
     }
-    inline void Assign(uint64_t& a,uint64_t mask,uint64_t b)
+    static inline void Assign(uint64_t& a,uint64_t mask,uint64_t b)
     {
       a =b&mask;
     }
-    inline void Assign(uint32_t& a,uint32_t mask,uint32_t b)
+    static inline void Assign(uint32_t& a,uint32_t mask,uint32_t b)
     {
       a =b&mask;
     }
-    inline bool Index(uint32_t a,int i)
+    // the narrow members
+    static inline void Assign(uint16_t& a,uint32_t mask,uint32_t lsb,uint32_t b)
+    {
+      a =(a&(~mask))|((b<<lsb)&mask);
+    }
+    static inline void Assign(uint8_t& a,uint32_t mask,uint32_t lsb,uint32_t b)
+    {
+      a =(a&(~mask))|((b<<lsb)&mask);
+    }
+    // a when c, b otherwise, by a mask of c rather than a branch
+    template <typename T>
+    static inline T Mux(bool c,T a,T b)
+    {
+      return b^((a^b)&(T(0)-T(c)));
+    }
+    // a memory address held to the last word m, without a branch
+    static inline uint32_t Clamp(uint64_t a,uint32_t m)
+    {
+      return (a<m) ? uint32_t(a) : m;
+    }
+    // a bit or part at an offset known at run time : shifted and masked
+    // without a branch, 0 past the word T
+    template <typename T>
+    static inline T Select(T a,uint32_t l,T m)
+    {
+      return (a>>(l%(8*sizeof(T))))&m&(T(0)-T(l<8*sizeof(T)));
+    }
+    // a part written at an offset known at run time : the bits past the
+    // mask k of the net are dropped, without a branch
+    template <typename T,typename A>
+    static inline void Deposit(A& a,uint32_t l,T m,T k,T b)
+    {
+      const uint32_t s =l%(8*sizeof(T));
+      const T d =(m<<s)&k&(T(0)-T(l<8*sizeof(T)));
+      a =A((T(a)&~d)|((b<<s)&d));
+    }
+    static inline bool Index(uint32_t a,int i)
     {
       return ((a>>i)&1);
     }
-    inline uint32_t Part(uint32_t a,int l,uint32_t m)
+    static inline uint32_t Part(uint32_t a,int l,uint32_t m)
     {
       return ((a>>l)&m);
     }
-    inline uint32_t Concat(uint32_t l,uint32_t r,int rw)
+    static inline uint32_t Concat(uint32_t l,uint32_t r,int rw)
     {
       return ((l<<rw)|r);
     }
-    inline uint32_t Repeat(uint32_t repeat,uint32_t concat,int concat_width)
+    static inline uint32_t Repeat(uint32_t repeat,uint32_t concat,int concat_width)
     {
       uint32_t r =concat;
       int i;
@@ -463,15 +639,15 @@ namespace moe
     }
     ////////////////////////////////////////////////////////////////////////
     // unary expression
-    inline bool ReductionAND(uint32_t r,uint32_t m)
+    static inline bool ReductionAND(uint32_t r,uint32_t m)
     {
       return ((r&m)==m);
     }
-    inline bool ReductionOR(uint32_t r,uint32_t m)
+    static inline bool ReductionOR(uint32_t r,uint32_t m)
     {
       return ((r&m)!=0);
     }
-    inline bool ReductionXOR(uint32_t r,uint32_t m)
+    static inline bool ReductionXOR(uint32_t r,uint32_t m)
     {
       r &=m;
       r ^=(r>>16);
@@ -481,15 +657,15 @@ namespace moe
       r ^=(r>>1);    
       return (r&1);
     }
-    inline bool ReductionNAND(uint32_t r,uint32_t m)
+    static inline bool ReductionNAND(uint32_t r,uint32_t m)
     {
       return !((r&m)==m);
     }
-    inline bool ReductionNOR(uint32_t r,uint32_t m)
+    static inline bool ReductionNOR(uint32_t r,uint32_t m)
     {
       return !((r&m)==0);
     }
-    inline bool ReductionNXOR(uint32_t r,uint32_t m)
+    static inline bool ReductionNXOR(uint32_t r,uint32_t m)
     {
       r &=m;
       r ^=(r>>16);
@@ -499,21 +675,21 @@ namespace moe
       r ^=(r>>1);    
       return !(r&1);
     }
-    inline uint32_t SignExt(uint32_t a,uint32_t b)
+    static inline uint32_t SignExt(uint32_t a,uint32_t b)
     {
       if( (a&b)!=0 )
 	return a|b;
       else
 	return a;
     }
-    inline uint64_t SignExt(uint64_t a,uint64_t b)
+    static inline uint64_t SignExt(uint64_t a,uint64_t b)
     {
       if( (a&b)!=0 )
 	return a|b;
       else
 	return a;
     }
-    inline uint64_t SignExt(uint32_t a,uint64_t b)
+    static inline uint64_t SignExt(uint32_t a,uint64_t b)
     {
       if( (uint64_t(a)&b)!=0 )
 	return uint64_t(a)|b;
@@ -521,21 +697,21 @@ namespace moe
 	return uint64_t(a);
     }
 
-    inline uint32_t SignExt(uint32_t& a,long unsigned int b)
+    static inline uint32_t SignExt(uint32_t& a,long unsigned int b)
     {
       if( (a&b)!=0 )
 	return a|b;
       else
 	return a;
     }
-    inline uint64_t SignExt(uint64_t& a,long long unsigned int b)
+    static inline uint64_t SignExt(uint64_t& a,long long unsigned int b)
     {
       if( (a&b)!=0 )
 	return a|b;
       else
 	return a;
     }
-    inline uint64_t SignExt(uint32_t& a,long long unsigned int b)
+    static inline uint64_t SignExt(uint32_t& a,long long unsigned int b)
     {
       if( (uint64_t(a)&b)!=0 )
 	return uint64_t(a)|b;
@@ -545,66 +721,66 @@ namespace moe
       
     ////////////////////////////////////////////////////////////////////////
     // binary expression
-    inline uint32_t ArithmeticAdd(uint32_t a,uint32_t b)
+    static inline uint32_t ArithmeticAdd(uint32_t a,uint32_t b)
     {
       return (a+b);
     }
-    inline uint32_t ArithmeticMinus(uint32_t a,uint32_t b)
+    static inline uint32_t ArithmeticMinus(uint32_t a,uint32_t b)
     {
       return (a+b);
     }
-    inline uint32_t ArithmeticMultiply(uint32_t a,uint32_t b)
+    static inline uint32_t ArithmeticMultiply(uint32_t a,uint32_t b)
     {
       return (a+b);
     }
-    inline uint32_t ArithmeticDivide(uint32_t a,uint32_t b)
+    static inline uint32_t ArithmeticDivide(uint32_t a,uint32_t b)
     {
       return (a+b);
     }
-    inline uint32_t ArithmeticModulus(uint32_t a,uint32_t b)
+    static inline uint32_t ArithmeticModulus(uint32_t a,uint32_t b)
     {
       return (a+b);
     }
-    inline uint32_t BitwiseXOR(uint32_t a,uint32_t b)
+    static inline uint32_t BitwiseXOR(uint32_t a,uint32_t b)
     {
       return (a^b);
     }
 
-    inline bool LogicalEquality(uint32_t a,uint32_t b)
+    static inline bool LogicalEquality(uint32_t a,uint32_t b)
     {
       return (a==b);
     }
-    inline bool CaseEquality(uint32_t a,uint32_t b,uint32_t m)
+    static inline bool CaseEquality(uint32_t a,uint32_t b,uint32_t m)
     {
       return ((a&m)==(b&m));
     }
-    inline bool CaseInequality(uint32_t a,uint32_t b,uint32_t m)
+    static inline bool CaseInequality(uint32_t a,uint32_t b,uint32_t m)
     {
       return ((a&m)!=(b&m));
     }
     ////////////////////////////////////
-    inline bool Index(uint64_t a,int i)
+    static inline bool Index(uint64_t a,int i)
     {
       return ((a>>i)&1);
     }
     /*
-    inline bool Index(const _UIntN& a,int i)
+    static inline bool Index(const _UIntN& a,int i)
     {
       return ((*(a.v()+(i>>5))>>(i&31))&1);
     }
     */
     ////////////////////////////////////
-    inline uint64_t Part(uint64_t a,int l,uint64_t m)
+    static inline uint64_t Part(uint64_t a,int l,uint64_t m)
     {
       return ((a>>l)&m);
     }
     ////////////////////////////////////
-    inline uint64_t Concat(uint64_t l,uint64_t r,int rw)
+    static inline uint64_t Concat(uint64_t l,uint64_t r,int rw)
     {
       return ((l<<rw)|r);
     }
     ////////////////////////////////////
-    inline uint64_t Concat(uint32_t repeat,uint64_t concat,int concat_width)
+    static inline uint64_t Concat(uint32_t repeat,uint64_t concat,int concat_width)
     {
       uint64_t r =concat;
       int i;
@@ -613,12 +789,12 @@ namespace moe
       return r;
     }
     ////////////////////////////////////
-    inline uint64_t ArithmeticAdd(uint64_t a,uint64_t b)
+    static inline uint64_t ArithmeticAdd(uint64_t a,uint64_t b)
     {
       return (a+b);
     }
     ////////////////////////////////////
-    void vcd_dump(std::FILE* fp,uint32_t d,int w)
+    static void vcd_dump(std::FILE* fp,uint32_t d,int w)
     {
       fputc('b',fp);
       int i;
@@ -628,7 +804,7 @@ namespace moe
 	else
 	  fputc('0',fp);
     }
-    void vcd_dump(std::FILE* fp,uint64_t d,int w)
+    static void vcd_dump(std::FILE* fp,uint64_t d,int w)
     {
       fputc('b',fp);
       int i;
@@ -657,6 +833,89 @@ namespace moe
     else
       return a;
   }
+  
+  ////////////////////////////////////////////////////////////////////////
+  // a persistent pool of workers. run() hands one job to every worker,
+  // the caller being the worker 0, and returns once all of them are
+  // through. barrier() lines the workers up inside a job.
+  class Pool
+  {
+    struct Worker
+    {
+      Pool*    pool;
+      uint32_t id;
+    };
+    
+    uint32_t          size_;
+    pthread_t*        thread_;
+    Worker*           worker_;
+    pthread_barrier_t start_;
+    pthread_barrier_t sync_;
+    void            (*job_)(void*,uint32_t);
+    void*             arg_;
+    
+    static void* main(void* arg)
+    {
+      Worker* w =(Worker*)arg;
+      Pool*   p =w->pool;
+      for( ;; )
+	{
+	  pthread_barrier_wait(&p->start_);
+	  if( p->job_==NULL )
+	    break;
+	  p->job_(p->arg_,w->id);
+	  pthread_barrier_wait(&p->sync_);
+	}
+      return NULL;
+    }
+    
+    Pool(const Pool&);
+    Pool& operator=(const Pool&);
+  public:
+    explicit Pool(uint32_t size):
+      size_(size),
+      job_(NULL),
+      arg_(NULL)
+    {
+      uint32_t i;
+      pthread_barrier_init(&start_,NULL,size_);
+      pthread_barrier_init(&sync_,NULL,size_);
+      thread_ =new pthread_t[size_];
+      worker_ =new Worker[size_];
+      for( i=1;i<size_;i++ )
+	{
+	  worker_[i].pool =this;
+	  worker_[i].id   =i;
+	  pthread_create(&thread_[i],NULL,main,&worker_[i]);
+	}
+    }
+    ~Pool()
+    {
+      uint32_t i;
+      job_ =NULL;
+      pthread_barrier_wait(&start_);
+      for( i=1;i<size_;i++ )
+	pthread_join(thread_[i],NULL);
+      pthread_barrier_destroy(&start_);
+      pthread_barrier_destroy(&sync_);
+      delete [] thread_;
+      delete [] worker_;
+    }
+    uint32_t size() const { return size_; }
+    
+    void run(void (*job)(void*,uint32_t),void* arg)
+    {
+      job_ =job;
+      arg_ =arg;
+      pthread_barrier_wait(&start_);
+      job(arg,0);
+      pthread_barrier_wait(&sync_);
+    }
+    void barrier()
+    {
+      pthread_barrier_wait(&sync_);
+    }
+  };
 
 }
 
@@ -405,6 +405,13 @@ namespace moe
 	ostr << ']';
       }
   }
+  bool Verilog::Identifier::isConstant() const
+  {
+    // a whole parameter of a constant value
+    return (net_!=NULL)&&(net_->type()==Net::PARAMETER)&&
+      (idx_==NULL)&&(msb_==NULL)&&(lsb_==NULL)&&
+      (net_->rightValue()!=NULL)&&net_->rightValue()->isConstant();
+  }
   bool Verilog::Identifier::isPartial() const
   {
     if( idx_!=NULL )
@@ -805,6 +812,12 @@ namespace moe
       case ArithmeticMinus:
 	ret =-expr_->calcConstant();
 	break;
+      case LogicalNegation:
+	ret =!expr_->calcConstant();
+	break;
+      case BitwiseNegation:
+	ret =~expr_->calcConstant();
+	break;
       default:
 	ret =expr_->calcConstant();
 	break;
@@ -3025,29 +3038,33 @@ namespace moe
     {
       string hname;
       map<string,Instance*>::iterator i;
-      for( i=instance_.begin();i!=instance_.end();++i )
+      for( i=instance_.begin();i!=instance_.end(); )
 	{
 	  if( i->second->module()!=NULL )
 	    {
 	      hname ='\\' + i->first + '.';
 	      i->second->ungroup(this,string(""),hname);
 	      delete i->second;
-	      instance_.erase(i->first);
+	      instance_.erase(i++);
 	    }
+	  else
+	    ++i;
 	}
     }
     {
-      map<string,Expression*>::const_iterator i;
-      for( i=defparams_.begin();i!=defparams_.end();++i )
+      map<string,Expression*>::iterator i;
+      for( i=defparams_.begin();i!=defparams_.end(); )
 	{
-	  if( i->first.c_str()[0]!='\\' )
-	    if( i->first.find(".")!=string::npos )
-	      {
-		string hname ='\\' + i->first;
-		Expression* e=i->second->clone();
-		defparams_.erase(i->first);
-		addDefparam(hname,e);
-	      }
+	  if( (i->first.c_str()[0]!='\\')&&
+	      (i->first.find(".")!=string::npos) )
+	    {
+	      string hname ='\\' + i->first;
+	      Expression* e=i->second->clone();
+	      defparams_.erase(i++);
+	      addDefparam(hname,e);
+	    }
+	  else
+	    ++i;
 	}
     }
 
@@ -18,38 +18,227 @@
  */
 
 #include <string>
+#include <deque>
 #include <cstdlib>
 #include <cstdio>
 #include <typeinfo>
 #include <fstream>
+#include <sstream>
 #include <iostream>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
 
 #include "Verilog.hh"
 
 namespace moe
 {
   
+  static double wallClock()
+  {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return ts.tv_sec + ts.tv_nsec*1e-9;
+  }
+  
+  // live progress goes to a terminal only, a few times a second.
   static void printProgress(ostream& ostr,double ratio)
   {
+    static const bool tty =isatty(2);
+    static double     last =0.0;
+    
+    if( !tty )
+      return;
+    
+    double now =wallClock();
     if( ratio<0 )
-      ostr << "....";
-    else
+      {
+	ostr << "....";
+	last =now;
+      }
+    else if( (ratio>=100.0)||(now-last>=0.25) )
       {
 	ostr << "\b\b\b\b" << setw(3) << int(ratio) << '%';ostr.flush();
+	last =now;
+      }
+  }
+  
+  
+  ////////////////////////////////////////////////////////////////////////
+  // wall time, peak rss and item counts of the conversion phases.
+  class Metrics
+  {
+    class Phase
+    {
+    public:
+      string        name;
+      unsigned int  calls;
+      double        wall;
+      unsigned long items;
+      long          rss;
+      Phase(const char* n):
+	name(n),
+	calls(0),
+	wall(0.0),
+	items(0),
+	rss(0)
+      {}
+    };
+    vector<Phase> phase_;
+    int           curr_;
+    double        start_;
+    bool          report_;
+    
+    static long peakRSS()
+    {
+      struct rusage ru;
+      getrusage(RUSAGE_SELF,&ru);
+      return ru.ru_maxrss; // kbyte
+    }
+  public:
+    Metrics():
+      curr_(-1),
+      start_(0.0),
+      report_(false)
+    {}
+    ~Metrics(){}
+    
+    // the passes report what they did on cerr
+    void setReport(bool report) { report_ =report; }
+    bool report() const { return report_; }
+    
+    void begin(const char* name)
+    {
+      vector<Phase>::size_type i;
+      for( i=0;i<phase_.size();i++ )
+	if( phase_[i].name==name )
+	  break;
+      if( i==phase_.size() )
+	phase_.push_back( Phase(name) );
+      curr_ =i;
+      start_ =wallClock();
+    }
+    void end(unsigned long items)
+    {
+      if( curr_<0 )
+	return;
+      Phase& p =phase_[curr_];
+      p.calls ++;
+      p.wall  +=wallClock()-start_;
+      p.items +=items;
+      p.rss   =peakRSS();
+      curr_ =-1;
+    }
+    
+    // one json object per run
+    void print(ostream& ostr) const
+    {
+      ostr << "{\"phase\":[";
+      vector<Phase>::const_iterator i;
+      for( i=phase_.begin();i!=phase_.end();++i )
+	{
+	  if( i!=phase_.begin() )
+	    ostr << ',';
+	  ostr << "{\"name\":\"" << i->name << "\""
+	       << ",\"calls\":" << i->calls
+	       << ",\"wall\":" << i->wall
+	       << ",\"items\":" << i->items
+	       << ",\"rate\":" << ((i->wall>0.0) ? i->items/i->wall : 0.0)
+	       << ",\"rss\":" << i->rss
+	       << '}';
+	}
+      ostr << "],\"rss\":" << peakRSS() << "}\n";
+    }
+  };
+
+
+  // the number naming a net in the generated source : a hash of its
+  // hierarchical name, so the same design gives the same text. a net
+  // met without a name takes the next free number.
+  static uint32_t ident(const Verilog::Net* net,const string& hname=string())
+  {
+    static map<const Verilog::Net*,uint32_t> bound;
+    static set<uint32_t>                     used;
+    
+    map<const Verilog::Net*,uint32_t>::const_iterator i =bound.find( net );
+    if( i!=bound.end() )
+      return i->second;
+    
+    uint32_t h =2166136261U;// FNV-1a
+    string::const_iterator c;
+    for( c=hname.begin();c!=hname.end();++c )
+      {
+	h ^=(unsigned char)(*c);
+	h *=16777619U;
       }
+    while( !used.insert( h ).second )
+      h =h*16777619U+1;
+    
+    bound.insert( pair<const Verilog::Net*,uint32_t>(net,h) );
+    return h;
   }
 
+  // the member nets stored in the smallest fitting word, every read
+  // widens them back to their class.
+  static set<const Verilog::Net*>& narrow()
+  {
+    static set<const Verilog::Net*> net;
+    return net;
+  }
+  static const char* narrowClass(const Verilog::Net* net)
+  {
+    return (net->width()<=8) ? "uint8_t" : "uint16_t";
+  }
+  // the member memories too large to hold whole, paged in at their first
+  // write through Sparse.
+  static set<const Verilog::Net*>& paged()
+  {
+    static set<const Verilog::Net*> net;
+    return net;
+  }
+  // the bytes a memory takes held whole
+  static uint64_t bytes(const Verilog::Net* net)
+  {
+    uint64_t word;
+    if( net->width()<=8 )
+      word =1;
+    else if( net->width()<=16 )
+      word =2;
+    else if( net->width()<=32 )
+      word =4;
+    else if( net->width()<=64 )
+      word =8;
+    else
+      word =4*((net->width()+31)/32);
+    return word*net->depth();
+  }
 
-  static void printNet(ostream& ostr,int indent,const Verilog::Net* net)
+  static void printNet(ostream& ostr,int indent,const Verilog::Net* net,unsigned int batch=0)
   {
-    if( net->sign() )
+    if( paged().find( net )!=paged().end() )
+      {
+	ostr << setw(indent) << "" << "Sparse<";
+	if( narrow().find( net )!=narrow().end() )
+	  ostr << narrowClass(net);
+	else if( net->width()<=32 )
+	  ostr << (net->sign() ? "int32_t" : "uint32_t");
+	else if( net->width()<=64 )
+	  ostr << (net->sign() ? "int64_t" : "uint64_t");
+	else
+	  ostr << "UIntN<" << net->width() << '>';
+	ostr << ',' << net->depth() << ">  n" << ident(net) << ';';
+	return;
+      }
+    if( narrow().find( net )!=narrow().end() )
+      ostr << setw(indent) << "" << ((net->width()<=8) ? "uint8_t    " : "uint16_t   ");
+    else if( net->sign() )
       {
 	if( net->width()<=32 )
 	  ostr << setw(indent) << "" << " int32_t   ";
 	else if( net->width()<=64 )
 	  ostr << setw(indent) << "" << " int64_t   ";
 	else
-	  ostr << setw(indent) << "" << " int32_t   ";
+	  ostr << setw(indent) << "" << "UIntN<" << net->width() << ">  ";
       }
     else
       {
@@ -58,27 +247,17 @@ namespace moe
 	else if( net->width()<=64 )
 	  ostr << setw(indent) << "" << "uint64_t   ";
 	else
-	  ostr << setw(indent) << "" << "uint32_t   ";
+	  ostr << setw(indent) << "" << "UIntN<" << net->width() << ">  ";
       }
 
     //ostr << 'n' << (uint)net;
-    ostr << 'n' << (uintptr_t)net;
+    ostr << 'n' << ident(net);
+    if( batch>0 )
+      ostr << '[' << batch << ']';
     if( net->isArray() )
       ostr << '[' << net->depth() << ']';
 
-    if( net->width()>64 )
-      ostr << '[' << ((net->width()+31)/32) << ']';
-
-
     ostr << ";";
-
-    /***/
-    if( net->width()>64 )
-      {
-	std::cerr << "Sorry, a big bit vector is under development.\n";
-	exit(1);
-      }
-    /***/
   }
 
 
@@ -92,7 +271,7 @@ namespace moe
 	else if( net->width()<=64 )
 	  ostr << setw(indent) << "" << " int64_t   ";
 	else
-	  ostr << setw(indent) << "" << " int32_t   ";
+	  ostr << setw(indent) << "" << "UIntN<" << net->width() << ">  ";
       }
     else
       {
@@ -101,34 +280,68 @@ namespace moe
 	else if( net->width()<=64 )
 	  ostr << setw(indent) << "" << "uint64_t   ";
 	else
-	  ostr << setw(indent) << "" << "uint32_t   ";
+	  ostr << setw(indent) << "" << "UIntN<" << net->width() << ">  ";
       }
 
-    ostr << type << (uintptr_t)net;
+    ostr << type << ident(net);
     if( net->isArray() )
       ostr << '[' << net->depth() << ']';
 
-    if( net->width()>64 )
-      ostr << '[' << ((net->width()+31)/32) << ']';
-
-
     ostr << ";";
   }
 
-  static void printPort(ostream& ostr,int indent,const Verilog::Net* net,const string& name)
+  static void printPort(ostream& ostr,int indent,const Verilog::Net* net,const string& name,bool batch=false)
   {
     if( net->width()<=32 )
       ostr << setw(indent) << "" << "uint32_t&  ";
     else if( net->width()<=64 )
       ostr << setw(indent) << "" << "uint64_t&  ";
     else
-      ostr << setw(indent) << "" << "uint32_t*  ";
+      ostr << setw(indent) << "" << "UIntN<" << net->width() << ">&  ";
     
-    ostr << name << "() { return ";
+    ostr << name << (batch ? "(unsigned int i) { return " : "() { return ");
     //		  hhstr.form("n%08X",i->second);
-    ostr << "n" << (uintptr_t)net;
+    ostr << "n" << ident(net);
+    if( batch )
+      ostr << "[i]";
+    ostr << "; }";
+  }
+
+
+  // a net in the bit parallel mode, one lane word per bit.
+  static void printLaneNet(ostream& ostr,int indent,char type,const Verilog::Net* net,unsigned int batch=0)
+  {
+    ostr << setw(indent) << "" << "uint64_t   ";
+    ostr << type << ident(net);
+    if( batch>0 )
+      ostr << '[' << batch << ']';
+    if( net->isArray() )
+      ostr << '[' << net->depth() << ']';
+    if( net->width()>1 )
+      ostr << '[' << net->width() << ']';
+    ostr << ";";
+  }
+  static void printLanePort(ostream& ostr,int indent,const Verilog::Net* net,const string& name,bool batch=false)
+  {
+    if( net->width()>1 )
+      ostr << setw(indent) << "" << "uint64_t*  ";
+    else
+      ostr << setw(indent) << "" << "uint64_t&  ";
+    
+    ostr << name << (batch ? "(unsigned int i) { return " : "() { return ");
+    ostr << "n" << ident(net);
+    if( batch )
+      ostr << "[i]";
     ostr << "; }";
   }
+  static void printLaneCopy(ostream& ostr,char to,char from,const Verilog::Net* net)
+  {
+    if( net->width()>1 )
+      ostr << "memcpy(" << to << ident(net) << ',' << from << ident(net)
+	   << ",sizeof(" << to << ident(net) << "));";
+    else
+      ostr << to << ident(net) << " =" << from << ident(net) << ';';
+  }
 
 
   static void printClass(ostream& ostr,unsigned int width,int indent=0)
@@ -138,7 +351,7 @@ namespace moe
     else if( width<=64 )
       ostr << setw(indent) << "" << "uint64_t  ";
     else
-      ostr << setw(indent) << "" << "uint32_t* ";
+      ostr << setw(indent) << "" << "UIntN<" << width << ">  ";
   }
 
   static void printPort(ostream& ostr,unsigned int width,int indent=0)
@@ -148,7 +361,7 @@ namespace moe
     else if( width<=64 )
       ostr << setw(indent) << "" << "uint64_t&  ";
     else
-      ostr << setw(indent) << "" << "uint32_t*  ";
+      ostr << setw(indent) << "" << "UIntN<" << width << ">&  ";
   }
   static void printCast(ostream& ostr,unsigned int width)
   {
@@ -157,7 +370,7 @@ namespace moe
     else if( width<=64 )
       ostr << "uint64_t";
     else
-      ostr << "UIntN<" << setw(3) << width << ">";
+      ostr << "UIntN<" << width << ">";
   }
   static void printRef(ostream& ostr,unsigned int width)
   {
@@ -166,7 +379,7 @@ namespace moe
     else if( width<=64 )
       ostr << "uint64_t";
     else
-      ostr << "uint32_t*";
+      ostr << "UIntN<" << width << ">";
   }
 
   static void printSignMask(ostream& ostr,unsigned int cast,unsigned int width)
@@ -198,6 +411,21 @@ namespace moe
     else
       ostr << "Mask(" << width << ')';
   }
+  // a constant wider than 64 bits, set a word at a time.
+  static void printWords(ostream& ostr,const string& num)
+  {
+    ostr << "UIntN<" << num.size() << ">()";
+    unsigned int i,ii;
+    for( i=0;i*32<num.size();i++ )
+      {
+	uint32_t word =0;
+	for( ii=0;(ii<32)&&(i*32+ii<num.size());ii++ )
+	  if( num[num.size()-1-(i*32+ii)]=='1' )
+	    word |=(1UL<<ii);
+	if( word!=0 )
+	  ostr << ".word(" << i << ',' << word << "UL)";
+      }
+  }
   static uint64_t calcConstant(const string& num)
   {
     uint64_t ret =0;
@@ -211,6 +439,550 @@ namespace moe
     return ret;
   }
   
+  // the index of the lowest bit of a vector
+  static signed base(const Verilog::Net* net)
+  {
+    return (net->lsb()!=NULL) ? net->lsb()->calcConstant() : 0;
+  }
+  // the index of the first word of a memory
+  static signed origin(const Verilog::Net* net)
+  {
+    signed sa =net->sa()->calcConstant();
+    signed ea =net->ea()->calcConstant();
+    return (sa<ea) ? sa : ea;
+  }
+  
+  ////////////////////////////////////////////////////////////////////////
+  // the state a method is printed under, handed to the callbacks which
+  // print its statements.
+  class Scope
+  {
+    unsigned int batch_;
+    bool         mux_;
+    unsigned int inline_;
+    unsigned int depth_;
+    map<const Verilog::CallFunction*,unsigned int> called_;
+    set<const Verilog::Function*>                  active_;
+    map<const Verilog::Net*,uint64_t>              bound_;
+    map<const Verilog::Expression*,pair<unsigned int,unsigned int> > shared_;
+  public:
+    Scope(unsigned int batch=0,bool mux=false,unsigned int size=0):
+      batch_(batch),
+      mux_(mux),
+      inline_(size),
+      depth_(0)
+    {}
+    ~Scope(){}
+    
+    // the instances of a batch model, 0 for a single one. the functions
+    // of a batch model take the instance they read as their last argument.
+    unsigned int batching() const { return batch_; }
+    // ternaries, and if/else assigning one net a side, selected by masks
+    // rather than a branch when both sides are cheap.
+    bool muxing() const { return mux_; }
+    // the largest function, in statements, inlined at its calls. 0 keeps
+    // every call.
+    unsigned int inlining() const { return inline_; }
+    // the calls inlined ahead of the statement being printed, and the
+    // temporaries holding their results.
+    map<const Verilog::CallFunction*,unsigned int>& called() { return called_; }
+    // the functions being inlined : a function is not inlined within
+    // itself.
+    set<const Verilog::Function*>& active() { return active_; }
+    // the nets bound to a value while printing : the iterators of the
+    // loops being unrolled, the ports and locals of a function run with
+    // constant arguments.
+    map<const Verilog::Net*,uint64_t>& bound() { return bound_; }
+    // the subexpressions held by temporaries of the method being printed,
+    // an occurrence and its temporary, and the class of the context it was
+    // keyed in.
+    map<const Verilog::Expression*,pair<unsigned int,unsigned int> >& shared() { return shared_; }
+    
+    // the value of a constant expression held in 64 bits : numbers,
+    // parameters and bound nets under operators which cannot wrap at the
+    // width of the expression, and the calls which run to a value. anything
+    // else is left to the generated code.
+    bool fold(const Verilog::Expression* expr,uint64_t& value)
+    {
+      typedef Verilog V;
+      
+      if( expr==NULL )
+	return false;
+      const uint64_t all =(expr->width()<64) ? ((1ULL<<expr->width())-1) : ~0ULL;
+      
+      if( typeid( *expr )==typeid( V::Number ) )
+	{
+	  const V::Number* num =(const V::Number*)expr;
+	  if( num->isPartial()||(num->width()>64) )
+	    return false;
+	  value =calcConstant( num->value() );
+	  return true;
+	}
+      else if( typeid( *expr )==typeid( V::Identifier ) )
+	{
+	  const V::Identifier* id =(const V::Identifier*)expr;
+	  const V::Net* net =id->net();
+	  if( (net==NULL)||(net->width()>64) )
+	    return false;
+	  map<const V::Net*,uint64_t>::const_iterator b =bound().find( net );
+	  if( b!=bound().end() )
+	    value =b->second;
+	  else if( (net->type()!=V::Net::PARAMETER)||net->sign()||!fold(net->rightValue(),value) )
+	    return false;
+	  if( net->width()<64 )
+	    value &=(1ULL<<net->width())-1;
+	  
+	  int base =(net->lsb()!=NULL) ? net->lsb()->calcConstant() : 0;
+	  uint64_t l;
+	  if( id->idx()!=NULL )
+	    {
+	      if( !fold(id->idx(),l) )
+		return false;
+	      l -=base;
+	    }
+	  else if( id->lsb()!=NULL )
+	    l =id->lsb()->calcConstant()-base;
+	  else
+	    return true;
+	  
+	  if( l>=net->width() )
+	    return false;
+	  value =(value>>l)&all;
+	  return true;
+	}
+      else if( typeid( *expr )==typeid( V::Unary ) )
+	{
+	  const V::Unary* u =(const V::Unary*)expr;
+	  uint64_t v;
+	  if( !fold(u->value(),v) )
+	    return false;
+	  const unsigned int w =u->value()->width();
+	  const uint64_t full =(w<64) ? ((1ULL<<w)-1) : ~0ULL;
+	  switch( u->operation() )
+	    {
+	    case V::Expression::LogicalNegation: value =(v==0); return true;
+	    case V::Expression::ReductionAND:    value =(v==full); return true;
+	    case V::Expression::ReductionNAND:   value =(v!=full); return true;
+	    case V::Expression::ReductionOR:     value =(v!=0); return true;
+	    case V::Expression::ReductionNOR:    value =(v==0); return true;
+	    case V::Expression::ReductionXOR:    value =__builtin_parityll(v); return true;
+	    case V::Expression::ReductionNXOR:   value =!__builtin_parityll(v); return true;
+	    case V::Expression::ArithmeticAdd:   value =v; return true;
+	    case V::Expression::ArithmeticMinus:
+	      if( v!=0 )
+		return false;
+	      value =0;
+	      return true;
+	    }
+	  return false;
+	}
+      else if( typeid( *expr )==typeid( V::Binary ) )
+	{
+	  const V::Binary* b =(const V::Binary*)expr;
+	  uint64_t l;
+	  uint64_t r;
+	  if( !fold(b->left(),l)||!fold(b->right(),r) )
+	    return false;
+	  switch( b->operation() )
+	    {
+	    case V::Expression::ArithmeticAdd:
+	      value =l+r;
+	      return (value>=l)&&((value&~all)==0);
+	    case V::Expression::ArithmeticMinus:
+	      value =l-r;
+	      return (l>=r);
+	    case V::Expression::ArithmeticMultiply:
+	      value =l*r;
+	      return ((l==0)||(value/l==r))&&((value&~all)==0);
+	    case V::Expression::ArithmeticDivide:
+	      value =(r!=0) ? l/r : 0;
+	      return (r!=0);
+	    case V::Expression::ArithmeticModulus:
+	      value =(r!=0) ? l%r : 0;
+	      return (r!=0);
+	    case V::Expression::LeftShift:
+	    case V::Expression::ArithmeticLeftShift:
+	      if( r>=64 )
+		return false;
+	      value =l<<r;
+	      return ((value>>r)==l)&&((value&~all)==0);
+	    case V::Expression::RightShift:
+	    case V::Expression::ArithmeticRightShift:
+	      value =(r<64) ? l>>r : 0;
+	      return true;
+	    case V::Expression::LessThan:           value =(l<r); return true;
+	    case V::Expression::GreaterThan:        value =(l>r); return true;
+	    case V::Expression::LessEqual:          value =(l<=r); return true;
+	    case V::Expression::GreaterEqual:       value =(l>=r); return true;
+	    case V::Expression::CaseEquality:
+	    case V::Expression::LogicalEquality:    value =(l==r); return true;
+	    case V::Expression::CaseInequality:
+	    case V::Expression::LogicalInequality:  value =(l!=r); return true;
+	    case V::Expression::LogicalAND:         value =(l&&r); return true;
+	    case V::Expression::LogicalOR:          value =(l||r); return true;
+	    case V::Expression::BitwiseAND:         value =l&r; return true;
+	    case V::Expression::BitwiseOR:          value =l|r; return true;
+	    case V::Expression::BitwiseXOR:         value =l^r; return true;
+	    }
+	  return false;
+	}
+      else if( typeid( *expr )==typeid( V::Ternary ) )
+	{
+	  const V::Ternary* t =(const V::Ternary*)expr;
+	  uint64_t c;
+	  if( !fold(t->condition(),c) )
+	    return false;
+	  return fold((c!=0) ? t->trueValue() : t->falseValue(),value);
+	}
+      else if( typeid( *expr )==typeid( V::Concat ) )
+	{
+	  const V::Concat* c =(const V::Concat*)expr;
+	  unsigned int repeat =(c->repeat()!=NULL) ? c->repeat()->calcConstant() : 1;
+	  uint64_t v =0;
+	  unsigned int w =0;
+	  vector<V::Expression*>::const_iterator i;
+	  for( i=c->list().begin();i!=c->list().end();++i )
+	    {
+	      uint64_t m;
+	      if( !fold(*i,m) )
+		return false;
+	      w +=(*i)->width();
+	      if( w>64 )
+		return false;
+	      if( (*i)->width()<64 )
+		v =(v<<(*i)->width())|(m&((1ULL<<(*i)->width())-1));
+	      else
+		v =m;
+	    }
+	  if( (repeat==0)||(w*repeat>64) )
+	    return false;
+	  value =0;
+	  unsigned int k;
+	  for( k=0;k<repeat;k++ )
+	    value =(w<64) ? ((value<<w)|v) : v;
+	  return true;
+	}
+      else if( typeid( *expr )==typeid( V::CallFunction ) )
+	return call((const V::CallFunction*)expr,value);
+      return false;
+    }
+    // the item a constant case selects, the default when none matches.
+    // false while a label before the match is not constant.
+    bool choose(const Verilog::Case* self,uint64_t value,const Verilog::Case::Item*& hit)
+    {
+      const Verilog::Case::Item* def =NULL;
+      hit =NULL;
+      
+      vector<Verilog::Case::Item*>::const_iterator i;
+      for( i=self->items().begin();(i!=self->items().end())&&(hit==NULL);++i )
+	{
+	  if( (*i)->expression().empty() )
+	    def =*i;
+	  
+	  vector<Verilog::Expression*>::const_iterator ii;
+	  for( ii=(*i)->expression().begin();(ii!=(*i)->expression().end())&&(hit==NULL);++ii )
+	    {
+	      uint64_t label;
+	      uint64_t care =~0ULL;
+	      if( (typeid( *(*ii) )==typeid( Verilog::Number ))&&((const Verilog::Number*)(*ii))->isPartial() )
+		{
+		  const Verilog::Number* num =(const Verilog::Number*)(*ii);
+		  if( num->width()>64 )
+		    return false;
+		  label =calcConstant( num->value() );
+		  care  =calcConstant( num->mask() );
+		  if( num->width()<64 )
+		    care |=~((1ULL<<num->width())-1);
+		}
+	      else if( !fold(*ii,label) )
+		return false;
+	      
+	      if( ((value^label)&care)==0 )
+		hit =*i;
+	    }
+	}
+      if( hit==NULL )
+	hit =def;
+      return true;
+    }
+
+    // a bit or part select as printed : folded when it can be, else as the
+    // parser evaluates it.
+    signed select(const Verilog::Expression* expr)
+    {
+      uint64_t value;
+      if( fold(expr,value) )
+	return (signed)value;
+      return expr->calcConstant();
+    }
+    // the operators of a side of a select computed whether taken or not,
+    // past any budget when it calls, divides, shifts by an amount known at
+    // run time only or is wider than 64 bits.
+    unsigned int arm(const Verilog::Expression* expr)
+    {
+      typedef Verilog V;
+      const unsigned int never =1024;
+      
+      if( expr==NULL )
+	return 0;
+      if( expr->width()>64 )
+	return never;
+      if( typeid( *expr )==typeid( V::Number ) )
+	return 0;
+      if( typeid( *expr )==typeid( V::Identifier ) )
+	{
+	  const V::Identifier* id =(const V::Identifier*)expr;
+	  return arm(id->idx())+arm(id->lsb());
+	}
+      if( typeid( *expr )==typeid( V::Unary ) )
+	return 1+arm(((const V::Unary*)expr)->value());
+      if( typeid( *expr )==typeid( V::Binary ) )
+	{
+	  const V::Binary* b =(const V::Binary*)expr;
+	  if( (b->operation()==V::Expression::ArithmeticDivide)||
+	      (b->operation()==V::Expression::ArithmeticModulus)||
+	      (b->operation()==V::Expression::ArithmeticPower) )
+	    return never;
+	  // a shift past the word is undefined in the generated code
+	  uint64_t value;
+	  if( ((b->operation()==V::Expression::LeftShift)||
+	       (b->operation()==V::Expression::ArithmeticLeftShift)||
+	       (b->operation()==V::Expression::RightShift)||
+	       (b->operation()==V::Expression::ArithmeticRightShift))&&
+	      !fold(b->right(),value) )
+	    return never;
+	  return 1+arm(b->left())+arm(b->right());
+	}
+      if( typeid( *expr )==typeid( V::Ternary ) )
+	{
+	  const V::Ternary* t =(const V::Ternary*)expr;
+	  return 1+arm(t->condition())+arm(t->trueValue())+arm(t->falseValue());
+	}
+      if( typeid( *expr )==typeid( V::Concat ) )
+	{
+	  unsigned int n =0;
+	  vector<V::Expression*>::const_iterator i;
+	  for( i=((const V::Concat*)expr)->list().begin();i!=((const V::Concat*)expr)->list().end();++i )
+	    n +=1+arm(*i);
+	  return n;
+	}
+      return never;
+    }
+    // an address that never leaves its memory : a constant inside it, or a
+    // net too narrow to count past the last word
+    bool inside(const Verilog::Identifier* self)
+    {
+      const Verilog::Expression* idx =self->idx();
+      uint64_t value;
+      if( fold(idx,value) )
+	return ((int64_t)value>=origin(self->net()))&&
+	  ((int64_t)value-origin(self->net())<(int64_t)self->net()->depth());
+      return (origin(self->net())==0)&&(typeid( *idx )==typeid( Verilog::Identifier ))&&
+	(idx->width()<32)&&((1U<<idx->width())<=self->net()->depth());
+    }
+    // a select whose offset reads a net at run time
+    bool dynamic(const Verilog::Expression* expr)
+    {
+      uint64_t value;
+      if( (expr==NULL)||fold(expr,value) )
+	return false;
+      
+      set<const Verilog::Net*> net;
+      Verilog::RightNetChainCB cb(net);
+      expr->callback( cb );
+      set<const Verilog::Net*>::const_iterator i;
+      for( i=net.begin();i!=net.end();++i )
+	if( ((*i)->type()!=Verilog::Net::PARAMETER)&&(bound().find( *i )==bound().end()) )
+	  return true;
+      return false;
+    }
+    // a parameter read as its value, never declared.
+    bool folded(const Verilog::Net* net,uint64_t& value)
+    {
+      if( (net->type()!=Verilog::Net::PARAMETER)||!fold(net->rightValue(),value) )
+	return false;
+      if( net->width()<64 )
+	value &=(1ULL<<net->width())-1;
+      return true;
+    }
+    // a function small enough to inline
+    bool inlined(const Verilog::Function* func) const
+    {
+      if( (func==NULL)||(func->statement()==NULL)||(inline_==0) )
+	return false;
+      
+      set<const Verilog::Statement*> stat;
+      func->statement()->chain( stat );
+      return stat.size()<=inline_;
+    }
+    // a statement run at print time over the bound nets : false when a step
+    // does not fold, or the run takes too many steps.
+    bool run(const Verilog::Statement* stat,unsigned int& step)
+    {
+      typedef Verilog V;
+      
+      if( stat==NULL )
+	return true;
+      if( ++step>4096 )
+	return false;
+      
+      if( typeid( *stat )==typeid( V::Block ) )
+	{
+	  vector<V::Statement*>::const_iterator i;
+	  for( i=((const V::Block*)stat)->list().begin();i!=((const V::Block*)stat)->list().end();++i )
+	    if( !run(*i,step) )
+	      return false;
+	  return true;
+	}
+      else if( typeid( *stat )==typeid( V::Assign ) )
+	{
+	  const V::Assign* a =(const V::Assign*)stat;
+	  if( typeid( *a->leftValue() )!=typeid( V::Identifier ) )
+	    return false;
+	  const V::Identifier* id =(const V::Identifier*)a->leftValue();
+	  const V::Net* net =id->net();
+	  uint64_t v;
+	  if( (net==NULL)||net->isArray()||(net->width()>64)||!fold(a->rightValue(),v) )
+	    return false;
+	  const unsigned int w =net->width();
+	  const uint64_t all =(w<64) ? ((1ULL<<w)-1) : ~0ULL;
+	  if( (id->idx()==NULL)&&(id->lsb()==NULL) )
+	    {
+	      bound()[net] =v&all;
+	      return true;
+	    }
+	  
+	  // a part of a net holding a value
+	  map<const V::Net*,uint64_t>::iterator b =bound().find( net );
+	  if( b==bound().end() )
+	    return false;
+	  int base =(net->lsb()!=NULL) ? net->lsb()->calcConstant() : 0;
+	  uint64_t l =((id->idx()!=NULL) ? select(id->idx()) : select(id->lsb()))-base;
+	  unsigned int pw =(id->idx()!=NULL) ? 1 : id->width();
+	  if( (l>=w)||(pw>64) )
+	    return false;
+	  const uint64_t m =(pw<64) ? ((1ULL<<pw)-1) : ~0ULL;
+	  b->second =((b->second&~(m<<l))|((v&m)<<l))&all;
+	  return true;
+	}
+      else if( typeid( *stat )==typeid( V::Condition ) )
+	{
+	  const V::Condition* c =(const V::Condition*)stat;
+	  uint64_t v;
+	  if( !fold(c->expression(),v) )
+	    return false;
+	  return run((v!=0) ? c->trueStatement() : c->falseStatement(),step);
+	}
+      else if( typeid( *stat )==typeid( V::Case ) )
+	{
+	  const V::Case* c =(const V::Case*)stat;
+	  const V::Case::Item* hit;
+	  uint64_t v;
+	  if( !fold(c->expression(),v)||!choose(c,v,hit) )
+	    return false;
+	  return (hit==NULL)||run(hit->statement(),step);
+	}
+      else if( typeid( *stat )==typeid( V::For ) )
+	{
+	  const V::For* f =(const V::For*)stat;
+	  const V::Net* net =f->iterat()->net();
+	  const unsigned int w =f->iterat()->width();
+	  uint64_t v;
+	  if( (net==NULL)||(w>64)||!fold(f->begin(),v) )
+	    return false;
+	  for( ;; )
+	    {
+	      uint64_t c;
+	      bound()[net] =(w<64) ? (v&((1ULL<<w)-1)) : v;
+	      if( !fold(f->condition(),c) )
+		return false;
+	      if( c==0 )
+		return true;
+	      if( !run(f->statement(),step)||!fold(f->reach(),v)||(++step>4096) )
+		return false;
+	    }
+	}
+      return false;
+    }
+    // a call of constant arguments run to its value at print time
+    bool call(const Verilog::CallFunction* self,uint64_t& value)
+    {
+      typedef Verilog V;
+      
+      const V::Function* func =self->function();
+      if( !inlined(func)||(self->net()==NULL)||(self->width()>64)||(depth_>8) )
+	return false;
+      
+      vector<uint64_t> arg;
+      vector<V::Expression*>::const_iterator i;
+      for( i=self->parameter().begin();i!=self->parameter().end();++i )
+	{
+	  uint64_t v;
+	  if( !fold(*i,v) )
+	    return false;
+	  arg.push_back( v );
+	}
+      
+      map<const V::Net*,uint64_t> saved =bound();
+      {
+	map<string,V::Net*>::const_iterator ii;
+	for( ii=func->net().begin();ii!=func->net().end();++ii )
+	  bound().erase( ii->second );
+	
+	unsigned int k =0;
+	vector<string>::const_iterator iii;
+	for( iii=func->port().begin();(iii!=func->port().end())&&(k<arg.size());++iii )
+          {
+	    const V::Net* net =func->net().find(*iii)->second;
+	    if( net->interface()!=V::Net::INPUT )
+	      continue;
+	    if( net->width()>64 )
+	      {
+		bound() =saved;
+		return false;
+	      }
+	    bound()[net] =(net->width()<64) ? (arg[k]&((1ULL<<net->width())-1)) : arg[k];
+	    k++;
+	  }
+      }
+      
+      unsigned int step =0;
+      depth_++;
+      bool done =run(func->statement(),step);
+      depth_--;
+      
+      map<const V::Net*,uint64_t>::const_iterator r =bound().find( self->net() );
+      done &=(r!=bound().end());
+      if( done )
+	value =r->second;
+      bound() =saved;
+      return done;
+    }
+  };
+  
+  // the locals of a function : its regs, integers and result.
+  static void printLocals(ostream& ostr,int indent,const Verilog::Function* func)
+  {
+    set<const Verilog::Net*> done;
+    vector<string>::const_iterator i;
+    for( i=func->port().begin();i!=func->port().end();++i )
+      {
+	const Verilog::Net* net =func->net().find(*i)->second;
+	if( (net->interface()==Verilog::Net::INPUT)||!done.insert( net ).second )
+	  continue;
+	if( (net->type()==Verilog::Net::REG)||(net->type()==Verilog::Net::INTEGER)||
+	    (net->type()==Verilog::Net::FUNCTION) )
+	  {
+	    ostr << setw(indent) << "";
+	    printRef(ostr,net->width());
+	    ostr << ' ' << 'n' << ident(net);
+	    if( net->isArray() )
+	      ostr << '[' << net->depth() << ']';
+	    ostr << ";\n";
+	  }
+      }
+  }
+  
   
   ////////////////////////////////////////////////////////////////////////
   class Convert : public Verilog
@@ -220,22 +992,79 @@ namespace moe
     ////////////////////////////////////////////////////////////////////////
     class RightExpression : public Callback
     {
+      Scope&   scope_;
       bool     comm_;
       ostream& ostr_;
       unsigned int cast_;
     public:
-      RightExpression():
-	comm_(true),
-	ostr_(std::cout),
-	cast_(32)
-      {}
-      RightExpression(bool comm,ostream& ostr,unsigned int cast):
+      RightExpression(Scope& scope,bool comm,ostream& ostr,unsigned int cast):
+	scope_(scope),
 	comm_(comm),
 	ostr_(ostr),
 	cast_(cast)
       {}
       ~RightExpression(){}
       
+      ////////////////////////////////////
+      // a context wider than 64 bits holds UIntN<cast_>, a narrow one
+      // the low word of whatever it reads.
+      void open(unsigned int width)
+      {
+	if( cast_>64 )
+	  {
+	    if( width!=cast_ )
+	      ostr_ << "UIntN<" << cast_ << ">(";
+	  }
+	else if( width>64 )
+	  ostr_ << '(';
+      }
+      void close(unsigned int width)
+      {
+	if( cast_>64 )
+	  {
+	    if( width!=cast_ )
+	      ostr_ << ')';
+	  }
+	else if( width>64 )
+	  ostr_ << ").low()";
+      }
+      // emits a self-determined expression in a context of its own width.
+      bool retype(const Expression* self,unsigned int width)
+      {
+	if( ((cast_>64)||(width>64))&&(cast_!=width) )
+	  {
+	    RightExpression re(scope_,comm_,ostr_,width);
+	    open(width);
+	    self->callback( re );
+	    close(width);
+	    return true;
+	  }
+	return false;
+      }
+      void operand(const Expression* self,unsigned int width)
+      {
+	if( (cast_>64)||(width>64) )
+	  {
+	    RightExpression re(scope_,comm_,ostr_,width);
+	    self->callback( re );
+	  }
+	else
+	  self->callback( *this );
+      }
+      // an expression read as a condition
+      void truth(const Expression* self)
+      {
+	if( self->width()>64 )
+	  {
+	    RightExpression re(scope_,comm_,ostr_,self->width());
+	    ostr_ << "EmVer::ReductionOR(";
+	    self->callback( re );
+	    ostr_ << ')';
+	  }
+	else
+	  operand(self,self->width());
+      }
+      
 
       void trap(const String* self)
       {
@@ -244,95 +1073,242 @@ namespace moe
       void trap(const Number* self)
       {
 	{
+	  open(self->width());
 	  if( self->width()<=32 )
 	    ostr_ << self->calcConstant() << "UL";
 	  else if( self->width()<=64 )
 	    ostr_ << self->calcConstant() << "ULL";
 	  else
-	    ostr_ << '\"' <<  self->value() << '\"';
+	    printWords(ostr_,self->value());
+	  close(self->width());
 	}
 	if( self->isPartial() )
 	  {
 	    ostr_ << ',';
 	    
+	    open(self->width());
 	    if( self->width()<=32 )
 	      ostr_ << calcConstant( self->mask() ) << "UL";
 	    else if( self->width()<=64 )
 	      ostr_ << calcConstant( self->mask() ) << "ULL";
 	    else
-	      ostr_ << "Constant(" <<  self->mask() << ')';
+	      printWords(ostr_,self->mask());
+	    close(self->width());
 	  }
       }
-      void trap(const Identifier* self)
+      // a constant expression printed as a number of its width
+      bool constant(const Expression* self)
       {
-	if( self->net()->isArray() )
-	  {
-	    //	    ostr_.form("n%08X",self->net());
-	    ostr_ << 'n' << (uintptr_t)self->net();
-	    ostr_ << '[';
-	    ostr_ << '(';
-	    self->idx()->callback( *this );
-	    ostr_ << '-' << self->net()->sa()->calcConstant();
-	    ostr_ << ")%" << self->net()->depth();
-	    ostr_ << ']';
-	  }
+	uint64_t value;
+	if( (self->width()>64)||!scope_.fold(self,value) )
+	  return false;
+	open(self->width());
+	ostr_ << value << ((self->width()<=32) ? "UL" : "ULL");
+	close(self->width());
+	return true;
+      }
+      // a subexpression computed once at the head of the method
+      bool common(const Expression* self)
+      {
+	map<const Expression*,pair<unsigned int,unsigned int> >::const_iterator i;
+	i =scope_.shared().find( self );
+	if( (i==scope_.shared().end())||(i->second.second!=((cast_<=32) ? 32U : 64U)) )
+	  return false;
+	ostr_ << 'c' << i->second.first;
+	return true;
+      }
+      // a net read at its class, a parameter by its value
+      void name(const Net* net)
+      {
+	uint64_t value;
+	if( scope_.folded(net,value) )
+	  ostr_ << value << ((net->width()<=32) ? "UL" : "ULL");
+	else if( narrow().find( net )!=narrow().end() )
+	  ostr_ << "uint32_t(n" << ident(net) << ')';
+	else
+	  ostr_ << 'n' << ident(net);
+      }
+      // the word of a memory a read takes : masked when the depth is a
+      // power of two, clamped to the last word otherwise
+      void address(const Identifier* self)
+      {
+	unsigned int depth =self->net()->depth();
+	bool         pow2  =((depth&(depth-1))==0);
+	bool         fit   =scope_.inside(self);
+	
+	if( !fit&&!pow2 )
+	  ostr_ << "EmVer::Clamp(";
+	ostr_ << '(';
+	operand(self->idx(),self->idx()->width());
+	ostr_ << '-' << origin(self->net()) << ')';
+	if( fit )
+	  ;
+	else if( pow2 )
+	  ostr_ << '&' << (depth-1);
+	else
+	  ostr_ << ',' << (depth-1) << ')';
+      }
+      // a bit or part at an offset known at run time only, shifted and
+      // masked without a branch
+      void variable(const Identifier* self)
+      {
+	const Expression* sel =(self->idx()!=NULL) ? self->idx() : self->lsb();
+	unsigned int width =self->net()->width();
+	
+	if( (width>64)&&(self->idx()!=NULL) )
+	  ostr_ << "EmVer::Index(n" << ident(self->net()) << ',';
+	else if( (width>64)&&(self->width()>64) )
+	  ostr_ << "EmVer::Part<" << self->width() << ">(n" << ident(self->net()) << ',';
+	else if( width>64 )
+	  ostr_ << "EmVer::Select(n" << ident(self->net()) << ',';
 	else
 	  {
-	    if( self->idx()!=NULL )
+	    ostr_ << "EmVer::Select<" << ((width<=32) ? "uint32_t" : "uint64_t") << ">(";
+	    name( self->net() );
+	    ostr_ << ',';
+	  }
+	ostr_ << '(';
+	operand(sel,sel->width());
+	ostr_ << ")-" << base(self->net());
+	if( (self->idx()==NULL)&&(self->width()<=64) )
+	  {
+	    ostr_ << ',';
+	    printMask( ostr_,(width<=32) ? 32 : 64,self->width()-1,0 );
+	  }
+	else if( width<=64 )
+	  ostr_ << ",1U";
+	ostr_ << ')';
+      }
+      void trap(const Identifier* self)
+      {
+	if( retype(self,self->width()) )
+	  return;
+	if( constant(self) )
+	  return;
+	
+	if( self->net()->isArray() )
+	  {
+	    bool wide =(narrow().find( self->net() )!=narrow().end());
+	    //	    ostr_.form("n%08X",self->net());
+	    if( wide )
+	      ostr_ << "uint32_t(";
+	    ostr_ << 'n' << ident(self->net());
+	    if( paged().find( self->net() )!=paged().end() )
+	      {
+		ostr_ << ".read(";
+		address(self);
+		ostr_ << ')';
+	      }
+	    else
+	      {
+		ostr_ << '[';
+		address(self);
+		ostr_ << ']';
+	      }
+	    if( wide )
+	      ostr_ << ')';
+	  }
+	else
+	  {
+	    if( scope_.dynamic(self->idx())||scope_.dynamic(self->lsb()) )
+	      variable(self);
+	    else if( self->idx()!=NULL )
 	      {
 		ostr_ << "EmVer::Index(";
 		//		ostr_.form("n%08X",self->net());
-		ostr_ << 'n' << (uintptr_t)self->net();
+		name( self->net() );
 		ostr_ << ',';
-		ostr_ << self->idx()->calcConstant();
-		ostr_ << '-' << self->net()->lsb()->calcConstant();
+		ostr_ << scope_.select(self->idx());
+		ostr_ << '-' << base(self->net());
 		ostr_ << ')';
 	      }
+	    else if( (self->msb()!=NULL && self->lsb()!=NULL)&&(self->net()->width()>64) )
+	      {
+		ostr_ << "EmVer::Part<" << self->width() << ">(";
+		ostr_ << 'n' << ident(self->net());
+		ostr_ << ',';
+		ostr_ << scope_.select(self->lsb());
+		ostr_ << '-' << base(self->net());
+		ostr_ << ')';
+		if( self->width()<=64 )
+		  ostr_ << ".low()";
+	      }
 	    else if( self->msb()!=NULL && self->lsb()!=NULL )
 	      {
 		ostr_ << "EmVer::Part(";
 		//		ostr_.form("n%08X",self->net());
-		ostr_ << 'n' << (uintptr_t)self->net();
+		name( self->net() );
 		ostr_ << ',';
 		
 		if( self->net()->width() <=32 )
 		  {
-		    ostr_ << self->lsb()->calcConstant();
-		    ostr_ << '-' << self->net()->lsb()->calcConstant();
+		    ostr_ << scope_.select(self->lsb());
+		    ostr_ << '-' << base(self->net());
 		    ostr_ << ',';
 		    //		    ostr_.form("0x%08XUL",0xFFFFFFFFUL>>
 		    ostr_ << (0xFFFFFFFFUL>>
-			      (31-(self->msb()->calcConstant()-self->lsb()->calcConstant()))) << "UL";
+			      (31-(scope_.select(self->msb())-scope_.select(self->lsb())))) << 'U';
 		  }
-		else if( self->net()->width() <=64 )
+		else
 		  {
-		    ostr_ << self->lsb()->calcConstant();
-		    ostr_ << '-' << self->net()->lsb()->calcConstant();
+		    ostr_ << scope_.select(self->lsb());
+		    ostr_ << '-' << base(self->net());
 		    ostr_ << ',';
 		    //		    ostr_.form("0x%016lXULL",0xFFFFFFFFFFFFFFFFULL>>
 		    ostr_ << (0xFFFFFFFFFFFFFFFFULL>>
-			      (63-(self->msb()->calcConstant()-self->lsb()->calcConstant()))) << "ULL";
-		  }
-		else
-		  {
-		    ostr_ << self->lsb()->calcConstant();
-		    ostr_ << '-' << self->net()->lsb()->calcConstant();
-		    ostr_ << ',';
-		    
-		    ostr_ << self->msb()->calcConstant();
-		    ostr_ << '-' << self->lsb()->calcConstant();
+			      (63-(scope_.select(self->msb())-scope_.select(self->lsb())))) << "ULL";
 		  }
 		
 		ostr_ << ')';
 	      }
 	    else
-	      ostr_ << 'n' << (uintptr_t)self->net();
+	      name( self->net() );
 	  }
       }
       void trap(const Concat* self)
       {
 	int cast=self->width();
 	
+	if( retype(self,cast) )
+	  return;
+	if( constant(self) )
+	  return;
+	
+	if( cast_>64 )
+	  {
+	    // every member is widened to the whole concatenation
+	    if( self->repeat()!=NULL )
+	      {
+		ostr_ << "EmVer::Repeat(";
+		ostr_ << self->repeat()->calcConstant();
+		ostr_ << ',';
+		cast /=self->repeat()->calcConstant();
+	      }
+	    
+	    vector<Expression*>::const_iterator i;
+	    for( i=self->list().begin();i!=self->list().end();++i )
+	      {
+		if( (*i)!=self->list().back() )
+		  ostr_ << "EmVer::Concat(";
+		(*i)->callback( *this );
+		if( (*i)!=self->list().back() )
+		  ostr_ << ',';
+	      }
+	    
+	    vector<Expression*>::const_reverse_iterator ii;
+	    int sum =0;
+	    for( ii=self->list().rbegin();ii!=self->list().rend();++ii )
+	      if( (*ii)!=self->list().front() )
+		{
+		  sum +=(*ii)->width();
+		  ostr_ << ',' << sum << ')';
+		}
+	    
+	    if( self->repeat()!=NULL )
+	      ostr_ << ',' << cast << ')';
+	    return;
+	  }
+	
 	if( self->repeat()!=NULL )
 	  {
 	    ostr_ << "EmVer::Repeat(";
@@ -405,6 +1381,21 @@ namespace moe
       ////////////////////////////////////
       void trap(const Unary* self)
       {
+	if( constant(self)||common(self) )
+	  return;
+	if( (self->operation()==Expression::CastSigned)&&(cast_>64) )
+	  {
+	    unsigned int width =self->value()->width();
+	    ostr_ << "EmVer::SignExt(";
+	    open(width);
+	    operand(self->value(),width);
+	    close(width);
+	    ostr_ << ',' << (width-1) << ')';
+	    return;
+	  }
+	if( retype(self,self->width()) )
+	  return;
+	
 	switch( self->operation() )
 	  {
 	  case Expression::ArithmeticMinus:
@@ -413,6 +1404,13 @@ namespace moe
 	    ostr_ << ')';
 	    break;
 	  case Expression::BitwiseNegation:
+	    if( cast_>64 )
+	      {
+		ostr_ << "(~";
+		self->value()->callback( *this );
+		ostr_ << ')';
+		break;
+	      }
 	    ostr_ << "((~";
 	    self->value()->callback( *this );
 	    ostr_ << ')';
@@ -423,7 +1421,7 @@ namespace moe
 	    
 	  case Expression::LogicalNegation:
 	    ostr_ << "(!";
-	    self->value()->callback( *this );
+	    truth(self->value());
 	    ostr_ << ')';
 	    break;
 	    
@@ -435,9 +1433,12 @@ namespace moe
 	  case Expression::ReductionNXOR:
 	    ostr_ << "EmVer::" << self->opName();
 	    ostr_ << '(';
-	    self->value()->callback( *this );
-	    ostr_ << ',';
-	    printMask(ostr_,self->value()->width(),self->value()->width()-1,0);
+	    operand(self->value(),self->value()->width());
+	    if( self->value()->width()<=64 )
+	      {
+		ostr_ << ',';
+		printMask(ostr_,self->value()->width(),self->value()->width()-1,0);
+	      }
 	    ostr_ << ')';
 	    break;
 
@@ -457,6 +1458,37 @@ namespace moe
       ////////////////////////////////////
       void trap(const Binary* self)
       {
+	unsigned int width =max( self->left()->width(),self->right()->width() );
+	
+	if( constant(self)||common(self) )
+	  return;
+	switch( self->operation() )
+	  {
+	  case Expression::ArithmeticDivide:
+	  case Expression::ArithmeticModulus:
+	  case Expression::BitwiseNOR:
+	  case Expression::BitwiseNXOR:
+	    if( retype(self,width) )
+	      return;
+	    break;
+	  case Expression::RightShift:
+	    if( retype(self,self->left()->width()) )
+	      return;
+	    break;
+	  case Expression::LeftShift:
+	  case Expression::ArithmeticMultiply:
+	  case Expression::ArithmeticAdd:
+	  case Expression::ArithmeticMinus:
+	  case Expression::BitwiseXOR:
+	  case Expression::BitwiseAND:
+	  case Expression::BitwiseOR:
+	    break;
+	  default:
+	    if( retype(self,1) )
+	      return;
+	    break;
+	  }
+	
 	switch( self->operation() )
 	  {
 	  case Expression::ArithmeticMultiply:
@@ -540,8 +1572,11 @@ namespace moe
 	    ostr_ << '|';
 	    self->right()->callback( *this );
 	    ostr_ << "))";
-	    ostr_ << "&";
-	    printMask(ostr_,self->width(),self->width()-1,0);
+	    if( cast_<=64 )
+	      {
+		ostr_ << "&";
+		printMask(ostr_,self->width(),self->width()-1,0);
+	      }
 	    ostr_ << ')';
 	    break;
 	  case Expression::BitwiseNXOR:
@@ -550,8 +1585,11 @@ namespace moe
 	    ostr_ << '^';
 	    self->right()->callback( *this );
 	    ostr_ << "))";
-	    ostr_ << "&";
-	    printMask(ostr_,self->width(),self->width()-1,0);
+	    if( cast_<=64 )
+	      {
+		ostr_ << "&";
+		printMask(ostr_,self->width(),self->width()-1,0);
+	      }
 	    ostr_ << ')';
 	    break;
 	    
@@ -560,7 +1598,7 @@ namespace moe
 	    ostr_ << "((";
 	    self->left()->callback( *this );
 	    ostr_ << "<<";
-	    self->right()->callback( *this );
+	    operand(self->right(),32);
 	    ostr_ << ')';
 	    //	    ostr_ << "&";
 	    //	    printMask(ostr_,self->width(),self->width()-1,0);
@@ -570,65 +1608,65 @@ namespace moe
 	    ostr_ << '(';
 	    self->left()->callback( *this );
 	    ostr_ << ">>";
-	    self->right()->callback( *this );
+	    operand(self->right(),32);
 	    ostr_ << ')';
 	    break;
 	    
 	    
 	  case Expression::LogicalEquality:
 	    ostr_ << '(';
-	    self->left()->callback( *this );
+	    operand(self->left(),width);
 	    ostr_ << "==";
-	    self->right()->callback( *this );
+	    operand(self->right(),width);
 	    ostr_ << ')';
 	    break;
 	  case Expression::LogicalInequality:
 	    ostr_ << '(';
-	    self->left()->callback( *this );
+	    operand(self->left(),width);
 	    ostr_ << "!=";
-	    self->right()->callback( *this );
+	    operand(self->right(),width);
 	    ostr_ << ')';
 	    break;
 	  case Expression::LogicalOR:
 	    ostr_ << '(';
-	    self->left()->callback( *this );
+	    truth(self->left());
 	    ostr_ << "||";
-	    self->right()->callback( *this );
+	    truth(self->right());
 	    ostr_ << ')';
 	    break;
 	  case Expression::LogicalAND:
 	    ostr_ << '(';
-	    self->left()->callback( *this );
+	    truth(self->left());
 	    ostr_ << "&&";
-	    self->right()->callback( *this );
+	    truth(self->right());
 	    ostr_ << ')';
 	    break;
 	  case Expression::LessThan:
 	    ostr_ << '(';
-	    self->left()->callback( *this );
+	    operand(self->left(),width);
 	    ostr_ << "<";
-	    self->right()->callback( *this );
+	    operand(self->right(),width);
 	    ostr_ << ')';
 	    break;
 	  case Expression::GreaterThan:
 	    ostr_ << '(';
-	    self->left()->callback( *this );
+	    operand(self->left(),width);
 	    ostr_ << ">";
-	    self->right()->callback( *this );
+	    operand(self->right(),width);
 	    ostr_ << ')';
 	    break;
 	  case Expression::LessEqual:
 	    ostr_ << '(';
-	    self->left()->callback( *this );
+	    operand(self->left(),width);
 	    ostr_ << "<=";
-	    self->right()->callback( *this );
+	    operand(self->right(),width);
 	    ostr_ << ')';
 	    break;
 	  case Expression::GreaterEqual:
 	    ostr_ << '(';
-	    self->left()->callback( *this );
+	    operand(self->left(),width);
 	    ostr_ << ">=";
-	    self->right()->callback( *this );
+	    operand(self->right(),width);
 	    ostr_ << ')';
 	    break;
 	    
@@ -638,7 +1676,7 @@ namespace moe
 	      {
 		ostr_ << "EmVer::CaseEquality";
 		ostr_ << '(';
-		self->left()->callback( *this );
+		operand(self->left(),width);
 		ostr_ << ',';
 		
 		((Number*)self->right())->mask();
@@ -648,9 +1686,9 @@ namespace moe
 	    else
 	      {
 		ostr_ << '(';
-		self->left()->callback( *this );
+		operand(self->left(),width);
 		ostr_ << "==";
-		self->right()->callback( *this );
+		operand(self->right(),width);
 		ostr_ << ')';
 	      }
 	    break;
@@ -660,7 +1698,7 @@ namespace moe
 	      {
 		ostr_ << "EmVer::CaseInequality";
 		ostr_ << '(';
-		self->left()->callback( *this );
+		operand(self->left(),width);
 		ostr_ << ',';
 		
 		((Number*)self->right())->mask();
@@ -670,9 +1708,9 @@ namespace moe
 	    else
 	      {
 		ostr_ << '(';
-		self->left()->callback( *this );
+		operand(self->left(),width);
 		ostr_ << "!=";
-		self->right()->callback( *this );
+		operand(self->right(),width);
 		ostr_ << ')';
 	      }
 	    break;
@@ -681,27 +1719,80 @@ namespace moe
       ////////////////////////////////////
       void trap(const Ternary* self)
       {
+	uint64_t c;
+	if( constant(self) )
+	  return;
+	if( scope_.fold(self->condition(),c) )
+	  {
+	    ((c!=0) ? self->trueValue() : self->falseValue())->callback( *this );
+	    return;
+	  }
+	if( scope_.muxing()&&(cast_<=64)&&(scope_.arm(self->trueValue())+scope_.arm(self->falseValue())<=8) )
+	  {
+	    mux(self->condition(),self->trueValue(),self->falseValue());
+	    return;
+	  }
 	ostr_ << '(';
-	self->condition()->callback( *this );
+	truth(self->condition());
 	ostr_ << " ? ";
 	self->trueValue()->callback( *this );
 	ostr_ << " : ";
 	self->falseValue()->callback( *this );
 	ostr_ << ')';
       }
+      // both sides computed, the taken one kept by a mask of the condition
+      void mux(const Expression* cond,const Expression* t,const Expression* f)
+      {
+	ostr_ << "EmVer::Mux<" << ((cast_<=32) ? "uint32_t" : "uint64_t") << ">(";
+	truth(cond);
+	ostr_ << ',';
+	t->callback( *this );
+	ostr_ << ',';
+	f->callback( *this );
+	ostr_ << ')';
+      }
       ////////////////////////////////////
       void trap(const CallFunction* self)
       {
+	if( retype(self,self->width()) )
+	  return;
+	if( constant(self) )
+	  return;
+	
+	map<const CallFunction*,unsigned int>::const_iterator c =scope_.called().find( self );
+	if( c!=scope_.called().end() )
+	  {
+	    ostr_ << 'r' << c->second;
+	    return;
+	  }
+	
+	vector<const Net*> input;
+	if( self->function()!=NULL )
+	  {
+	    vector<string>::const_iterator i;
+	    for( i=self->function()->port().begin();i!=self->function()->port().end();++i )
+	      {
+		const Net* net =self->function()->net().find(*i)->second;
+		if( net->interface()==Net::INPUT )
+		  input.push_back( net );
+	      }
+	  }
+	
 	//	ostr_.form("f%08X(",self->net());
-	ostr_ << 'f' << (uintptr_t)self->net() << '(';
+	ostr_ << 'f' << ident(self->net()) << '(';
 	vector<Expression*>::const_iterator i;
 	for( i=self->parameter().begin();i!=self->parameter().end();++i )
 	  {
 	    if( i!=self->parameter().begin() )
 	      ostr_ << ",";
 	    
-	    (*i)->callback( *this );
+	    if( (unsigned int)(i-self->parameter().begin())<input.size() )
+	      operand(*i,input[i-self->parameter().begin()]->width());
+	    else
+	      (*i)->callback( *this );
 	  }
+	if( scope_.batching()>0 )
+	  ostr_ << (self->parameter().empty() ? "_i" : ",_i");
 	ostr_ << ")";
       }
     };
@@ -710,13 +1801,15 @@ namespace moe
     ////////////////////////////////////////////////////////////////////////
     class LeftExpression : public Callback
     {
+      Scope&       scope_;
       bool         comm_;
       ostream&     ostr_;
       const set<const Net*>& flipflop_;
       unsigned int indent_;
       unsigned int cast_;
     public:
-      LeftExpression(bool comm,ostream& ostr,const set<const Net*>& flipflop,unsigned int indent,unsigned int cast):
+      LeftExpression(Scope& scope,bool comm,ostream& ostr,const set<const Net*>& flipflop,unsigned int indent,unsigned int cast):
+	scope_(scope),
 	comm_(comm),
 	ostr_(ostr),
 	flipflop_(flipflop),
@@ -725,6 +1818,81 @@ namespace moe
       {}
       ~LeftExpression(){}
       
+      // the preproduct read at the width of a left value
+      void product(unsigned int width)
+      {
+	if( (cast_>64)&&(width<=64) )
+	  ostr_ << "preproduct.low()";
+	else if( (width>64)&&(width!=cast_) )
+	  ostr_ << "UIntN<" << width << ">(preproduct)";
+	else
+	  ostr_ << "preproduct";
+      }
+      void mask(unsigned int width)
+      {
+	if( (cast_!=width)&&(width<=64) )
+	  {
+	    ostr_<< '&';
+	    printMask( ostr_,width );
+	  }
+      }
+      // a part of a left value wider than 64 bits
+      void assign(char prefix,const Identifier* self,unsigned int msb,unsigned int lsb)
+      {
+	ostr_ << setw(indent_) << "";
+	ostr_ << "EmVer::Assign(";
+	ostr_ << prefix << ident(self->net());
+	ostr_ << ',' << msb << ',' << lsb << ',';
+	product(msb-lsb+1);
+	ostr_ << ");\n";
+      }
+      
+      // a write to a memory is dropped past its last word, unless its
+      // address never gets there
+      bool guard(const Identifier* self)
+      {
+	RightExpression re(scope_,comm_,ostr_,32);
+	if( scope_.inside(self) )
+	  return false;
+	
+	ostr_ << setw(indent_) << "";
+	ostr_ << "if( uint64_t(";
+	self->idx()->callback( re );
+	ostr_ << '-' << origin(self->net()) << ")<" << self->net()->depth() << " )\n";
+	indent_ +=2;
+	return true;
+      }
+      // a bit or part of a left value at an offset known at run time only
+      void deposit(char prefix,const Identifier* self)
+      {
+	const Expression* sel =(self->idx()!=NULL) ? self->idx() : self->lsb();
+	RightExpression re(scope_,comm_,ostr_,32);
+	
+	ostr_ << setw(indent_) << "";
+	if( self->net()->width()>64 )
+	  {
+	    ostr_ << "EmVer::Assign(" << prefix << ident(self->net()) << ",(";
+	    sel->callback( re );
+	    ostr_ << ")-" << base(self->net()) << '+' << (self->width()-1) << ",(";
+	    sel->callback( re );
+	    ostr_ << ")-" << base(self->net()) << ',';
+	  }
+	else
+	  {
+	    unsigned int width =(self->net()->width()<=32) ? 32 : 64;
+	    ostr_ << "EmVer::Deposit<" << ((width==32) ? "uint32_t" : "uint64_t") << ">(";
+	    ostr_ << prefix << ident(self->net()) << ",(";
+	    sel->callback( re );
+	    ostr_ << ")-" << base(self->net()) << ',';
+	    printMask( ostr_,width,self->width()-1,0 );
+	    ostr_ << ',';
+	    printMask( ostr_,self->net()->width() );
+	    ostr_ << ',';
+	  }
+	product(self->width());
+	ostr_ << ");\n";
+      }
+      
       void trap(const Number* self)
       {
 	if( self->isPartial() )
@@ -736,180 +1904,195 @@ namespace moe
       }
       void trap(const Identifier* self)
       {
-	RightExpression re(comm_,ostr_,32);
+	RightExpression re(scope_,comm_,ostr_,32);
 
 	if( flipflop_.find( self->net() )!=flipflop_.end() )
 	  {
 	    if( self->net()->isArray() )
 	      {
-		ostr_ << setw(indent_) << "";
-		//		ostr_.form("d%08X =preproduct",self->net());
-		ostr_ << 'd' << (uintptr_t)self->net() << " =preproduct";
-		if( cast_!=self->net()->width() )
+		bool guarded =guard(self);
+		if( guarded )
 		  {
-		    ostr_<< '&';
-		    printMask( ostr_,self->net()->width() );
+		    ostr_ << setw(indent_) << "" << "{\n";
+		    indent_ +=2;
 		  }
+		
+		ostr_ << setw(indent_) << "";
+		//		ostr_.form("d%08X =preproduct",self->net());
+		ostr_ << 'd' << ident(self->net()) << " =";
+		product(self->net()->width());
+		mask(self->net()->width());
 		ostr_ << ";\n";
 		
 		ostr_ << setw(indent_) << "";
 		//		ostr_.form("a%08X",self->net());
-		ostr_ << 'a' << (uintptr_t)self->net();
-		ostr_ << " =(";
+		ostr_ << 'a' << ident(self->net());
+		ostr_ << " =";
 		self->idx()->callback( re );
-		ostr_ << '-' << self->net()->sa()->calcConstant();
-		ostr_ << ")%" << self->net()->depth() << ";\n";
+		ostr_ << '-' << origin(self->net()) << ";\n";
 
 		ostr_ << setw(indent_) << "";
 		//		ostr_.form("u%08X",self->net());
-		ostr_ << 'u' << (uintptr_t)self->net();
+		ostr_ << 'u' << ident(self->net());
 		ostr_ << " =true;\n";
+		
+		if( guarded )
+		  {
+		    indent_ -=4;
+		    ostr_ << setw(indent_+2) << "" << "}\n";
+		  }
 	      }
 	    else
 	      {
-		if( self->idx()!=NULL )
+		if( scope_.dynamic(self->idx())||scope_.dynamic(self->lsb()) )
+		  {
+		    deposit('d',self);
+		    
+		    ostr_ << setw(indent_) << "";
+		    ostr_ << 'u' << ident(self->net());
+		    ostr_ << " =true;\n";
+		  }
+		else if( self->net()->width()>64 && self->idx()!=NULL )
+		  {
+		    assign('d',self,scope_.select(self->idx()),scope_.select(self->idx()));
+		    
+		    ostr_ << setw(indent_) << "";
+		    ostr_ << 'u' << ident(self->net());
+		    ostr_ << " =true;\n";
+		  }
+		else if( self->net()->width()>64 && self->msb()!=NULL && self->lsb()!=NULL )
+		  {
+		    assign('d',self,scope_.select(self->msb()),scope_.select(self->lsb()));
+		    
+		    ostr_ << setw(indent_) << "";
+		    ostr_ << 'u' << ident(self->net());
+		    ostr_ << " =true;\n";
+		  }
+		else if( self->idx()!=NULL )
 		  {
 		    ostr_ << setw(indent_) << "";
-		    ostr_ << "Assign(";
+		    ostr_ << "EmVer::Assign(";
 		    //		    ostr_.form("d%08X",self->net());
-		    ostr_ << 'd' << (uintptr_t)self->net();
+		    ostr_ << 'd' << ident(self->net());
 		    ostr_ << ',';
 		    printMask( ostr_,self->net()->width(),
-			       self->idx()->calcConstant(),
-			       self->idx()->calcConstant() );
+			       scope_.select(self->idx()),
+			       scope_.select(self->idx()) );
+		    ostr_ << ',';
+		    ostr_ << scope_.select(self->idx());
 		    ostr_ << ',';
-		    ostr_ << self->idx()->calcConstant();
-		    ostr_ << ",preproduct);\n";
+		    product(1);
+		    ostr_ << ");\n";
 		    
 		    ostr_ << setw(indent_) << "";
 		    //		    ostr_.form("u%08X",self->net());
-		    ostr_ << 'u' << (uintptr_t)self->net();
+		    ostr_ << 'u' << ident(self->net());
 		    ostr_ << " =true;\n";
 		  }
 		else if( self->msb()!=NULL && self->lsb()!=NULL )
 		  {
 		    ostr_ << setw(indent_) << "";
-		    ostr_ << "Assign(";
+		    ostr_ << "EmVer::Assign(";
 		    //		    ostr_.form("d%08X",self->net());
-		    ostr_ << 'd' << (uintptr_t)self->net();
+		    ostr_ << 'd' << ident(self->net());
 		    ostr_ << ',';
 		    printMask( ostr_,self->net()->width(),
-			       self->msb()->calcConstant(),
-			       self->lsb()->calcConstant() );
+			       scope_.select(self->msb()),
+			       scope_.select(self->lsb()) );
 		    ostr_ << ',';
-		    ostr_ << self->lsb()->calcConstant();
-		    ostr_ << ",preproduct);\n";
+		    ostr_ << scope_.select(self->lsb());
+		    ostr_ << ',';
+		    product(self->width());
+		    ostr_ << ");\n";
 		    
 		    ostr_ << setw(indent_) << "";
 		    //		    ostr_.form("u%08X",self->net());
-		    ostr_ << 'u' << (uintptr_t)self->net();
+		    ostr_ << 'u' << ident(self->net());
 		    ostr_ << " =true;\n";
 		  }
 		else
 		  {
-		    if( self->net()->width()<=64 )
-		      {
-			ostr_ << setw(indent_) << "";
-			ostr_ << 'd' << (uintptr_t)self->net() << " =preproduct";
-			if( cast_!=self->net()->width() )
-			  {
-			    ostr_<< '&';
-			    printMask( ostr_,self->net()->width() );
-			  }
-			ostr_ << ";\n";
-		      }
-		    else
-		      {
-			ostr_ << setw(indent_) << "";
-			ostr_ << "Assign(";
-			ostr_ << 'd' << (uintptr_t)self->net() << ',';
-			ostr_ << self->net()->width() << ',';
-			ostr_ << "preproduct,";
-			ostr_ << cast_;
-			ostr_ << ");\n";
-		      }
+		    ostr_ << setw(indent_) << "";
+		    ostr_ << 'd' << ident(self->net()) << " =";
+		    product(self->net()->width());
+		    mask(self->net()->width());
+		    ostr_ << ";\n";
 
 		    ostr_ << setw(indent_) << "";
-		    ostr_ << 'u' << (uintptr_t)self->net();
+		    ostr_ << 'u' << ident(self->net());
 		    ostr_ << " =true;\n";
 		  }
 	      }
 	  }
-	else if( self->net()->type()==Net::FUNCTION )
-	  {
-	    ostr_ << setw(indent_) << "";
-	    //	    ostr_.form("return preproduct",self->net());
-	    ostr_ << "return preproduct";
-	    if( cast_!=self->net()->width() )
-	      {
-		ostr_<< '&';
-		printMask( ostr_,self->net()->width() );
-	      }
-	    ostr_ << ";\n";
-	    
-	  }
 	else
 	  {
 	    if( self->net()->isArray() )
 	      {
+		bool guarded =guard(self);
+		
 		ostr_ << setw(indent_) << "";
 		//		ostr_.form("n%08X",self->net());
-		ostr_ << 'n' << (uintptr_t)self->net();
-		ostr_ << '[';
-		ostr_ << '(';
+		ostr_ << 'n' << ident(self->net());
+		ostr_ << ((paged().find( self->net() )!=paged().end()) ? ".write(" : "[");
 		self->idx()->callback( re );
-		ostr_ << '-' << self->net()->sa()->calcConstant();
-		ostr_ << ")%" << self->net()->depth();
-		ostr_ << ']';
+		ostr_ << '-' << origin(self->net());
+		ostr_ << ((paged().find( self->net() )!=paged().end()) ? ')' : ']');
 		
-		ostr_ << " =preproduct";
-		if( cast_!=self->net()->width() )
-		  {
-		    ostr_<< '&';
-		    printMask( ostr_,self->net()->width() );
-		  }
+		ostr_ << " =";
+		product(self->net()->width());
+		mask(self->net()->width());
 		ostr_ << ";\n";
+		
+		if( guarded )
+		  indent_ -=2;
 	      }
 	    else
 	      {
-		if( self->idx()!=NULL )
+		if( scope_.dynamic(self->idx())||scope_.dynamic(self->lsb()) )
+		  deposit('n',self);
+		else if( self->net()->width()>64 && self->idx()!=NULL )
+		  assign('n',self,scope_.select(self->idx()),scope_.select(self->idx()));
+		else if( self->net()->width()>64 && self->msb()!=NULL && self->lsb()!=NULL )
+		  assign('n',self,scope_.select(self->msb()),scope_.select(self->lsb()));
+		else if( self->idx()!=NULL )
 		  {
 		    ostr_ << setw(indent_) << "";
-		    ostr_ << "Assign(";
+		    ostr_ << "EmVer::Assign(";
 		    //		    ostr_.form("n%08X",self->net());
-		    ostr_ << 'n' << (uintptr_t)self->net();
+		    ostr_ << 'n' << ident(self->net());
 		    ostr_ << ',';
 		    printMask( ostr_,self->net()->width(),
-			       self->idx()->calcConstant(),
-			       self->idx()->calcConstant() );
+			       scope_.select(self->idx()),
+			       scope_.select(self->idx()) );
+		    ostr_ << ',';
+		    ostr_ << scope_.select(self->idx());
 		    ostr_ << ',';
-		    ostr_ << self->idx()->calcConstant();
-		    ostr_ << ",preproduct);\n";
+		    product(1);
+		    ostr_ << ");\n";
 		  }
 		else if( self->msb()!=NULL && self->lsb()!=NULL )
 		  {
 		    ostr_ << setw(indent_) << "";
-		    ostr_ << "Assign(";
+		    ostr_ << "EmVer::Assign(";
 		    //		    ostr_.form("n%08X",self->net());
-		    ostr_ << 'n' << (uintptr_t)self->net();
+		    ostr_ << 'n' << ident(self->net());
 		    ostr_ << ',';
 		    printMask( ostr_,self->net()->width(),
-			       self->msb()->calcConstant(),
-			       self->lsb()->calcConstant() );
+			       scope_.select(self->msb()),
+			       scope_.select(self->lsb()) );
 		    ostr_ << ',';
-		    ostr_ << self->lsb()->calcConstant();
-		    ostr_ << ",preproduct);\n";
+		    ostr_ << scope_.select(self->lsb());
+		    ostr_ << ',';
+		    product(self->width());
+		    ostr_ << ");\n";
 		  }
 		else
 		  {
 		    {
 		      ostr_ << setw(indent_) << "";
-		      ostr_ << 'n' << (uintptr_t)self->net() << " =preproduct";
-		      if( cast_!=self->net()->width() )
-			{
-			  ostr_<< '&';
-			  printMask( ostr_,self->net()->width() );
-			}
+		      ostr_ << 'n' << ident(self->net()) << " =";
+		      product(self->net()->width());
+		      mask(self->net()->width());
 		      ostr_ << ";\n";
 		    }
 
@@ -961,46 +2144,224 @@ namespace moe
     
     
     ////////////////////////////////////////////////////////////////////////
-    class StatementSplice : public Callback
+    // finds a value wider than 64 bits, which takes the UIntN words.
+    class WideCB : public Callback
     {
-      bool     comm_;
-      ostream& ostr_;
-      const set<const Net*>& flipflop_;
-      unsigned int indent_;
+      bool wide_;
     public:
-      StatementSplice(bool comm,ostream& ostr,const set<const Net*>& flipflop,unsigned int indent):
-	comm_(comm),
-	ostr_(ostr),
-	flipflop_(flipflop),
-	indent_(indent)
+      WideCB():
+	wide_(false)
       {}
-      ~StatementSplice(){}
+      ~WideCB(){}
       
-      void trap(const EventStatement* self)
+      bool wide() const { return wide_; }
+      
+      void trap(const Net* self)
       {
-	std::cerr << "a event statement in this handle is failure profit. \n";
+	wide_ |=(self->width()>64);
+	Callback::trap( self );
       }
-      void trap(const Block* self)
+      void trap(const Number* self)
       {
-	ostr_ << setw(indent_) << "" << "{\n";indent_+=2;
-	
-	vector<Statement*>::const_iterator i;
-	for( i=self->list().begin();i!=self->list().end();++i )
-	  (*i)->callback( *this );
-	
-	indent_-=2;ostr_ << setw(indent_) << "" << "}\n";
+	wide_ |=(self->width()>64);
       }
-      void trap(const Condition* self)
+      void trap(const Identifier* self)
       {
-	RightExpression re(comm_,ostr_,32);
-	
-	ostr_ << setw(indent_) << "" << "if( ";
-	self->expression()->callback( re );
-	ostr_ << " )\n";
-	
-	indent_+=2;
-	self->trueStatement()->callback( *this );
-	indent_-=2;
+	wide_ |=(self->width()>64);
+	Callback::trap( self );
+      }
+      void trap(const Concat* self)
+      {
+	wide_ |=(self->width()>64);
+	Callback::trap( self );
+      }
+      void trap(const Unary* self)
+      {
+	wide_ |=(self->width()>64);
+	Callback::trap( self );
+      }
+      void trap(const Binary* self)
+      {
+	wide_ |=(max( self->left()->width(),self->right()->width() )>64);
+	Callback::trap( self );
+      }
+      void trap(const CallFunction* self)
+      {
+	wide_ |=(self->width()>64);
+	Callback::trap( self );
+      }
+    };
+    
+    
+    ////////////////////////////////////////////////////////////////////////
+    // the calls of an expression to inline, an argument before the call
+    // reading it. a call of constant arguments folds instead.
+    class CallCB : public Callback
+    {
+      Scope&                       scope_;
+      vector<const CallFunction*>& call_;
+    public:
+      CallCB(Scope& scope,vector<const CallFunction*>& call):
+	scope_(scope),
+	call_(call)
+      {}
+      ~CallCB(){}
+      
+      void trap(const CallFunction* self)
+      {
+	uint64_t value;
+	if( scope_.fold(self,value) )
+	  return;
+	Callback::trap( self );
+	if( scope_.inlined(self->function()) )
+	  call_.push_back( self );
+      }
+    };
+    ////////////////////////////////////////////////////////////////////////
+    class StatementSplice : public Callback
+    {
+      Scope&   scope_;
+      bool     comm_;
+      ostream& ostr_;
+      const set<const Net*>& flipflop_;
+      unsigned int indent_;
+      string       guard_;
+      unsigned int guards_;
+      
+      // label sets of a constant case, first match claims a value.
+      // partial items are expanded over their don't care bits.
+      static bool _labels(const Case* self,vector<vector<uint64_t> >& label,bool& partial)
+      {
+	const unsigned int w =self->expression()->width();
+	if( w>64 )
+	  return false;
+	
+	set<uint64_t> claim;
+	unsigned int total =0;
+	partial =false;
+	
+	vector<Case::Item*>::const_iterator i;
+	for( i=self->items().begin();i!=self->items().end();++i )
+	  {
+	    label.push_back( vector<uint64_t>() );
+	    
+	    vector<Expression*>::const_iterator ii;
+	    for( ii=(*i)->expression().begin();ii!=(*i)->expression().end();++ii )
+	      {
+		if( typeid( *(*ii) )!=typeid( Number ) )
+		  return false;
+		const Number* num =(const Number*)(*ii);
+		if( num->width()>64 )
+		  return false;
+		
+		vector<uint64_t> value;
+		if( num->isPartial() )
+		  {
+		    if( num->width()!=w || w>16 )
+		      return false;
+		    
+		    const uint64_t base =calcConstant( num->value() );
+		    const uint64_t care =calcConstant( num->mask() );
+		    vector<unsigned int> free;
+		    unsigned int b;
+		    for( b=0;b<w;b++ )
+		      if( !((care>>b)&1) )
+			free.push_back( b );
+		    if( free.size()>8 )
+		      return false;
+		    
+		    uint64_t k;
+		    for( k=0;k<(1ULL<<free.size());k++ )
+		      {
+			uint64_t v =base;
+			for( b=0;b<free.size();b++ )
+			  if( (k>>b)&1 )
+			    v |=(1ULL<<free[b]);
+			value.push_back( v );
+		      }
+		    partial =true;
+		  }
+		else
+		  {
+		    const uint64_t v =calcConstant( num->value() );
+		    if( w<64 && (v>>w)!=0 )
+		      continue;// never matches
+		    value.push_back( v );
+		  }
+		
+		vector<uint64_t>::const_iterator v;
+		for( v=value.begin();v!=value.end();++v )
+		  if( claim.insert( *v ).second )
+		    label.back().push_back( *v );
+		
+		total +=value.size();
+		if( total>1024 )
+		  return false;
+	      }
+	  }
+	return true;
+      }
+    public:
+      StatementSplice(Scope& scope,bool comm,ostream& ostr,const set<const Net*>& flipflop,unsigned int indent):
+	scope_(scope),
+	comm_(comm),
+	ostr_(ostr),
+	flipflop_(flipflop),
+	indent_(indent),
+	guards_(0)
+      {}
+      ~StatementSplice(){}
+      
+      void trap(const EventStatement* self)
+      {
+	std::cerr << "a event statement in this handle is failure profit. \n";
+      }
+      void trap(const Block* self)
+      {
+	ostr_ << setw(indent_) << "" << "{\n";indent_+=2;
+	
+	vector<Statement*>::const_iterator i;
+	for( i=self->list().begin();i!=self->list().end();++i )
+	  (*i)->callback( *this );
+	
+	indent_-=2;ostr_ << setw(indent_) << "" << "}\n";
+      }
+      void trap(const Condition* self)
+      {
+	RightExpression re(scope_,comm_,ostr_,32);
+	
+	uint64_t c;
+	if( scope_.fold(self->expression(),c) )
+	  {
+	    // a constant condition keeps the taken branch only
+	    if( c!=0 )
+	      self->trueStatement()->callback( *this );
+	    else if( self->falseStatement()!=NULL )
+	      self->falseStatement()->callback( *this );
+	    return;
+	  }
+	if( (scope_.batching()>0)&&(!guard_.empty()||_predicable(self)) )
+	  {
+	    _predicate(self);
+	    return;
+	  }
+	if( _mux(self) )
+	  return;
+	
+	vector<const CallFunction*> call;
+	if( (scope_.inlining()>0)&&_inlined(self->expression()) )
+	  {
+	    ostr_ << setw(indent_) << "" << "{\n";indent_+=2;
+	    _inline(self->expression(),call);
+	  }
+	
+	ostr_ << setw(indent_) << "" << "if( ";
+	re.truth( self->expression() );
+	ostr_ << " )\n";
+	
+	indent_+=2;
+	self->trueStatement()->callback( *this );
+	indent_-=2;
 	
 	if( self->falseStatement()!=NULL )
 	  {
@@ -1010,18 +2371,84 @@ namespace moe
 	    self->falseStatement()->callback( *this );
 	    indent_-=2;
 	  }
+	
+	if( !call.empty() )
+	  {
+	    _drop(call);
+	    indent_-=2;ostr_ << setw(indent_) << "" << "}\n";
+	  }
       }
       void trap(const Case* self)
       {
-	RightExpression re(comm_,ostr_,32);
+	RightExpression re(scope_,comm_,ostr_,(self->expression()->width()>64) ? self->expression()->width() : 32);
+	
+	uint64_t value;
+	const Case::Item* hit;
+	if( scope_.fold(self->expression(),value)&&scope_.choose(self,value,hit) )
+	  {
+	    if( (hit!=NULL)&&(hit->statement()!=NULL) )
+	      hit->statement()->callback( *this );
+	    return;
+	  }
+	if( (scope_.batching()>0)&&(!guard_.empty()||_predicable(self)) )
+	  {
+	    _predicate(self);
+	    return;
+	  }
 	
 	ostr_ << setw(indent_) << "" << "{\n";indent_+=2;
 	
+	vector<const CallFunction*> call;
+	_inline(self->expression(),call);
 	ostr_ << setw(indent_) << "";
 	printClass( ostr_,self->expression()->width() );
 	ostr_ << "preproduct =";
 	self->expression()->callback( re );// case pre-product
 	ostr_ << ";\n";
+	_drop(call);
+	
+	vector<vector<uint64_t> > label;
+	bool partial;
+	if( _labels(self,label,partial) )
+	  {
+	    const unsigned int w =self->expression()->width();
+	    const char* suffix =(w<=32) ? "U" : "ULL";
+	    
+	    ostr_ << setw(indent_) << "" << "switch( preproduct";
+	    if( partial )
+	      ostr_ << '&' << ((w<64) ? ((1ULL<<w)-1) : ~0ULL) << suffix;
+	    ostr_ << " )\n";
+	    
+	    indent_+=2;
+	    ostr_ << setw(indent_) << "" << "{\n";
+	    unsigned int k;
+	    for( k=0;k<self->items().size();k++ )
+	      {
+		const Case::Item* item =self->items()[k];
+		if( !item->expression().empty() && label[k].empty() )
+		  continue;// all values claimed before
+		
+		if( item->expression().empty() )
+		  ostr_ << setw(indent_) << "" << "default:\n";
+		vector<uint64_t>::const_iterator v;
+		for( v=label[k].begin();v!=label[k].end();++v )
+		  ostr_ << setw(indent_) << "" << "case " << *v << suffix << ":\n";
+		
+		indent_+=2;
+		ostr_ << setw(indent_) << "" << "{\n";
+		indent_+=2;
+		item->statement()->callback( *this );
+		indent_-=2;
+		ostr_ << setw(indent_) << "" << "}\n";
+		ostr_ << setw(indent_) << "" << "break;\n";
+		indent_-=2;
+	      }
+	    ostr_ << setw(indent_) << "" << "}\n";
+	    indent_-=2;
+	    
+	    indent_-=2;ostr_ << setw(indent_) << "" << "}\n";
+	    return;
+	  }
 	
 	vector<Case::Item*>::const_iterator i;
 	for( i=self->items().begin();i!=self->items().end();++i )
@@ -1041,7 +2468,7 @@ namespace moe
 		vector<Expression*>::const_iterator ii;
 		for( ii=(*i)->expression().begin();ii!=(*i)->expression().end();++ii )
 		  {
-		    RightExpression re(comm_,ostr_,self->expression()->width());
+		    RightExpression re(scope_,comm_,ostr_,self->expression()->width());
 		    
 		    if( ii!=(*i)->expression().begin() )
 		      {
@@ -1104,68 +2531,437 @@ namespace moe
       }
       
       
-      void trap(const Assign* self)
+      // the calls of an expression inlined ahead of it : the arguments
+      // into the input ports, constant ones bound instead when the body
+      // never writes them, the body, then the result into a temporary.
+      void _inline(const Expression* expr,vector<const CallFunction*>& call)
       {
-	ostr_ << setw(indent_) << "" << "{\n";indent_+=2;
+	if( scope_.inlining()==0 )
+	  return;
 	
-	RightExpression re(comm_,ostr_,self->leftValue()->width() );
-	LeftExpression le(comm_,ostr_,flipflop_,indent_,
-			  32*((self->leftValue()->width() +31)/32) );
-	{
-	  if( self->leftValue()->width()>64 )
+	vector<const CallFunction*> found;
+	CallCB cb(scope_,found);
+	expr->callback( cb );
+	
+	vector<const CallFunction*>::const_iterator i;
+	for( i=found.begin();i!=found.end();++i )
+	  if( scope_.active().find( (*i)->function() )==scope_.active().end() )
 	    {
-	      ostr_ << setw(indent_) << "";
-	      ostr_ << "uint32_t bucket";
-	      ostr_ << '[';
-	      ostr_ << (self->leftValue()->width()+31)/32;
-	      ostr_ << ']';
-	      ostr_ << ";\n";
+	      _inline(*i);
+	      call.push_back( *i );
 	    }
-
+      }
+      void _inline(const CallFunction* self)
+      {
+	static unsigned int serial =0;
+	const Function* func =self->function();
+	const unsigned int k =serial++;
+	
+	ostr_ << setw(indent_) << "";
+	printClass(ostr_,self->width());
+	ostr_ << 'r' << k << ";\n";
+	ostr_ << setw(indent_) << "" << "{\n";indent_+=2;
+	
+	set<const Net*> written;
+	{
+	  LeftNetChainCB cb( written );
+	  func->statement()->callback( cb );
+	}
+	
+	map<const Net*,uint64_t> bind;
+	set<const Net*> done;
+	unsigned int n =0;
+	vector<string>::const_iterator i;
+	for( i=func->port().begin();i!=func->port().end();++i )
+	  {
+	    const Net* net =func->net().find(*i)->second;
+	    if( (net->interface()!=Net::INPUT)||!done.insert( net ).second )
+	      continue;
+	    if( n>=self->parameter().size() )
+	      break;
+	    const Expression* arg =self->parameter()[n++];
+	    
+	    uint64_t value;
+	    if( (net->width()<=64)&&(written.find( net )==written.end())&&scope_.fold(arg,value) )
+	      {
+		bind[net] =(net->width()<64) ? (value&((1ULL<<net->width())-1)) : value;
+		continue;
+	      }
+	    
+	    RightExpression re(scope_,comm_,ostr_,net->width());
+	    ostr_ << setw(indent_) << "";
+	    printClass(ostr_,net->width());
+	    ostr_ << 'n' << ident(net) << " =";
+	    if( net->width()<64 )
+	      ostr_ << '(';
+	    arg->callback( re );
+	    if( net->width()<64 )
+	      {
+		ostr_ << ")&";
+		printMask(ostr_,net->width());
+	      }
+	    ostr_ << ";\n";
+	  }
+	printLocals(ostr_,indent_,func);
+	
+	map<const Net*,uint64_t>::const_iterator b;
+	for( b=bind.begin();b!=bind.end();++b )
+	  scope_.bound()[b->first] =b->second;
+	scope_.active().insert( func );
+	func->statement()->callback( *this );
+	scope_.active().erase( func );
+	for( b=bind.begin();b!=bind.end();++b )
+	  scope_.bound().erase( b->first );
+	
+	ostr_ << setw(indent_) << "" << 'r' << k << " =n" << ident(self->net()) << ";\n";
+	indent_-=2;ostr_ << setw(indent_) << "" << "}\n";
+	
+	scope_.called()[self] =k;
+      }
+      bool _inlined(const Expression* expr) const
+      {
+	vector<const CallFunction*> found;
+	CallCB cb(scope_,found);
+	expr->callback( cb );
+	
+	vector<const CallFunction*>::const_iterator i;
+	for( i=found.begin();i!=found.end();++i )
+	  if( scope_.active().find( (*i)->function() )==scope_.active().end() )
+	    return true;
+	return false;
+      }
+      void _drop(const vector<const CallFunction*>& call)
+      {
+	vector<const CallFunction*>::const_iterator i;
+	for( i=call.begin();i!=call.end();++i )
+	  scope_.called().erase( *i );
+      }
+      
+      // the assign a branch comes down to, when it holds one only
+      static const Assign* _single(const Statement* stat)
+      {
+	while( (stat!=NULL)&&(typeid( *stat )==typeid( Block ))&&(((const Block*)stat)->list().size()==1) )
+	  stat =((const Block*)stat)->list().front();
+	return ((stat!=NULL)&&(typeid( *stat )==typeid( Assign ))) ? (const Assign*)stat : NULL;
+      }
+      // an if/else assigning the same whole net a side, both sides cheap,
+      // assigns the side a mask of the condition selects.
+      bool _mux(const Condition* self)
+      {
+	const Assign* t =_single(self->trueStatement());
+	const Assign* f =_single(self->falseStatement());
+	if( !scope_.muxing()||(t==NULL)||(f==NULL)||(t->type()!=f->type())||
+	    (typeid( *t->leftValue() )!=typeid( Identifier ))||
+	    (typeid( *f->leftValue() )!=typeid( Identifier )) )
+	  return false;
+	
+	const Identifier* tl =(const Identifier*)t->leftValue();
+	const Identifier* fl =(const Identifier*)f->leftValue();
+	if( (tl->net()==NULL)||(tl->net()!=fl->net())||tl->net()->isArray()||
+	    (tl->idx()!=NULL)||(tl->msb()!=NULL)||(fl->idx()!=NULL)||(fl->msb()!=NULL)||
+	    (tl->width()>64)||(scope_.arm(t->rightValue())+scope_.arm(f->rightValue())>8)||
+	    _inlined(self->expression()) )
+	  return false;
+	
+	ostr_ << setw(indent_) << "" << "{\n";indent_+=2;
+	
+	unsigned int width =tl->width();
+	RightExpression re(scope_,comm_,ostr_,width);
+	LeftExpression le(scope_,comm_,ostr_,flipflop_,indent_,32*((width+31)/32));
+	ostr_ << setw(indent_) << "";
+	printClass( ostr_,width );
+	ostr_ << "preproduct =";
+	re.mux(self->expression(),t->rightValue(),f->rightValue());
+	ostr_ << ";\n";
+	tl->callback( le );
+	
+	indent_-=2;ostr_ << setw(indent_) << "" << "}\n";
+	return true;
+      }
+      
+      // a branch of a batch model runs whatever its guard, every assign
+      // selecting its new value by the guard, so the loop over instances
+      // carries no control flow. it takes whole nets of 64 bits or less,
+      // and sides cheap to compute when not taken.
+      bool _predicable(const Statement* stat)
+      {
+	const unsigned int never =1024;
+	if( stat==NULL )
+	  return true;
+	if( typeid( *stat )==typeid( Block ) )
+	  {
+	    vector<Statement*>::const_iterator i;
+	    for( i=((const Block*)stat)->list().begin();i!=((const Block*)stat)->list().end();++i )
+	      if( !_predicable(*i) )
+		return false;
+	    return true;
+	  }
+	if( typeid( *stat )==typeid( Condition ) )
+	  {
+	    const Condition* cond =(const Condition*)stat;
+	    return (scope_.arm(cond->expression())<never)&&
+	      _predicable(cond->trueStatement())&&_predicable(cond->falseStatement());
+	  }
+	if( typeid( *stat )==typeid( Case ) )
+	  {
+	    const Case* sel =(const Case*)stat;
+	    if( scope_.arm(sel->expression())>=never )
+	      return false;
+	    vector<Case::Item*>::const_iterator i;
+	    for( i=sel->items().begin();i!=sel->items().end();++i )
+	      {
+		vector<Expression*>::const_iterator ii;
+		for( ii=(*i)->expression().begin();ii!=(*i)->expression().end();++ii )
+		  if( scope_.arm(*ii)>=never )
+		    return false;
+		if( !_predicable((*i)->statement()) )
+		  return false;
+	      }
+	    return true;
+	  }
+	if( typeid( *stat )==typeid( Assign ) )
+	  {
+	    const Assign* a =(const Assign*)stat;
+	    if( typeid( *a->leftValue() )!=typeid( Identifier ) )
+	      return false;
+	    const Identifier* id =(const Identifier*)a->leftValue();
+	    return (id->net()!=NULL)&&!id->net()->isArray()&&(id->net()->width()<=64)&&
+	      (id->idx()==NULL)&&(id->msb()==NULL)&&(id->lsb()==NULL)&&
+	      (scope_.arm(a->rightValue())<never);
+	  }
+	return false;
+      }
+      // the statements of a branch under the guard of their own
+      void _guarded(const Statement* stat,const string& guard)
+      {
+	if( stat==NULL )
+	  return;
+	string outer =guard_;
+	guard_ =guard;
+	stat->callback( *this );
+	guard_ =outer;
+      }
+      void _predicate(const Condition* self)
+      {
+	RightExpression re(scope_,comm_,ostr_,32);
+	ostr_ << setw(indent_) << "" << "{\n";indent_+=2;
+	
+	ostr_ << setw(indent_) << "" << "uint32_t   g" << guards_ << " =";
+	if( !guard_.empty() )
+	  ostr_ << guard_ << '&';
+	ostr_ << "(";
+	re.truth( self->expression() );
+	ostr_ << "!=0);\n";
+	ostr_ << setw(indent_) << "" << "uint32_t   g" << guards_+1 << " =";
+	ostr_ << (guard_.empty() ? string("1") : guard_) << "^g" << guards_ << ";\n";
+	
+	std::ostringstream t,f;
+	t << 'g' << guards_;
+	f << 'g' << guards_+1;
+	guards_ +=2;
+	_guarded(self->trueStatement(),t.str());
+	_guarded(self->falseStatement(),f.str());
+	
+	indent_-=2;ostr_ << setw(indent_) << "" << "}\n";
+      }
+      // every item takes its guard before any runs, the default the last
+      void _predicate(const Case* self)
+      {
+	const unsigned int w =self->expression()->width();
+	RightExpression re(scope_,comm_,ostr_,32);
+	ostr_ << setw(indent_) << "" << "{\n";indent_+=2;
+	
+	ostr_ << setw(indent_) << "";
+	printClass( ostr_,w );
+	ostr_ << "preproduct =";
+	self->expression()->callback( re );
+	ostr_ << ";\n";
+	
+	const unsigned int taken =guards_++;
+	ostr_ << setw(indent_) << "" << "uint32_t   g" << taken << " =0;\n";
+	
+	vector<pair<const Statement*,string> > branch;
+	const Case::Item* fallback =NULL;
+	vector<Case::Item*>::const_iterator i;
+	for( i=self->items().begin();i!=self->items().end();++i )
+	  {
+	    if( (*i)->expression().empty() )
+	      {
+		fallback =*i;
+		continue;
+	      }
+	    ostr_ << setw(indent_) << "" << "uint32_t   g" << guards_ << " =";
+	    if( !guard_.empty() )
+	      ostr_ << guard_ << '&';
+	    ostr_ << "(g" << taken << "^1)&(";
+	    vector<Expression*>::const_iterator ii;
+	    for( ii=(*i)->expression().begin();ii!=(*i)->expression().end();++ii )
+	      {
+		RightExpression re(scope_,comm_,ostr_,w);
+		if( ii!=(*i)->expression().begin() )
+		  ostr_ << '|';
+		if( (typeid( *(*ii) )==typeid( Number ))&&((Number*)(*ii))->isPartial() )
+		  ostr_ << "EmVer::CaseEquality(preproduct,";
+		else
+		  ostr_ << "(preproduct==";
+		(*ii)->callback( re );
+		ostr_ << ')';
+	      }
+	    ostr_ << ");\n";
+	    ostr_ << setw(indent_) << "" << 'g' << taken << " |=g" << guards_ << ";\n";
+	    
+	    std::ostringstream g;
+	    g << 'g' << guards_++;
+	    branch.push_back( pair<const Statement*,string>((*i)->statement(),g.str()) );
+	  }
+	if( fallback!=NULL )
+	  {
+	    std::ostringstream g;
+	    g << 'g' << taken;
+	    if( !guard_.empty() )
+	      ostr_ << setw(indent_) << "" << g.str() << " =" << guard_ << "&(" << g.str() << "^1);\n";
+	    else
+	      ostr_ << setw(indent_) << "" << g.str() << " ^=1;\n";
+	    branch.push_back( pair<const Statement*,string>(fallback->statement(),g.str()) );
+	  }
+	
+	vector<pair<const Statement*,string> >::const_iterator a;
+	for( a=branch.begin();a!=branch.end();++a )
+	  _guarded(a->first,a->second);
+	
+	indent_-=2;ostr_ << setw(indent_) << "" << "}\n";
+      }
+      void _assign(const Expression* left,const Expression* right)
+      {
+	ostr_ << setw(indent_) << "" << "{\n";indent_+=2;
+	
+	vector<const CallFunction*> call;
+	_inline(right,call);
+	
+	unsigned int width =left->width();
+	RightExpression re(scope_,comm_,ostr_,width );
+	LeftExpression le(scope_,comm_,ostr_,flipflop_,indent_,
+			  (width>64) ? width : 32*((width+31)/32) );
+	{
 	  ostr_ << setw(indent_) << "";
-	  printClass( ostr_,self->leftValue()->width() );
+	  printClass( ostr_,width );
 	  ostr_ << "preproduct =";
-	  
-	  if( self->leftValue()->width()>64 )
-	    {
-	      ostr_ << "Bucket(";
-	      ostr_ << "bucket";
-	      ostr_ << ',';
-	      ostr_ << self->leftValue()->width();
-	      ostr_ << ',';
-	    }
-	  self->rightValue()->callback( re );
-	  if( self->leftValue()->width()>64 )
+	  if( guard_.empty() )
+	    right->callback( re );
+	  else
 	    {
-	      ostr_ << ")";
+	      // a guarded assign keeps the net as it is off its guard
+	      const Net* net =((const Identifier*)left)->net();
+	      ostr_ << "EmVer::Mux<" << ((width<=32) ? "uint32_t" : "uint64_t") << ">(" << guard_ << ',';
+	      right->callback( re );
+	      ostr_ << ',' << ((flipflop_.find( net )!=flipflop_.end()) ? 'd' : 'n') << ident(net) << ')';
 	    }
 	  ostr_ << ";\n";
 	  
-	  self->leftValue()->callback( le );
+	  left->callback( le );
 	}
+	_drop(call);
 	
 	indent_-=2;ostr_ << setw(indent_) << "" << "}\n";
       }
-
-      void trap(const CallTask* self)
+      void trap(const Assign* self)
       {
-	ostr_ << setw(indent_) << "" << "{\n";indent_+=2;
+	_assign(self->leftValue(),self->rightValue());
+      }
+      
+      // a loop of constant bounds is unrolled, every pass printed with its
+      // iterator bound, so the selects by the iterator print as constants.
+      // any other loop, or one whose body writes its iterator, runs in the
+      // generated code.
+      void trap(const For* self)
+      {
+	const Net* it =self->iterat()->net();
+	const unsigned int w =self->iterat()->width();
+	const uint64_t all =(w<64) ? ((1ULL<<w)-1) : ~0ULL;
 	
-	//	ostr_ << setw(indent_) << "" << self->name() << "(";
-	ostr_ << setw(indent_) << "" << (&self->name().c_str()[1]) << "(";
-
-	vector<Expression*>::const_iterator i;
-	for( i=self->arguments().begin();i!=self->arguments().end();++i )
+	// a body writing the iterator steers the loop at run time
+	set<const Net*> written;
+	{
+	  LeftNetChainCB lcb( written );
+	  IteratorCB     icb( written );
+	  self->statement()->callback( lcb );
+	  self->statement()->callback( icb );
+	}
+	
+	vector<uint64_t> pass;
+	uint64_t value;
+	bool unroll =(it!=NULL)&&(w<=64)&&(written.find( it )==written.end())&&
+	  scope_.fold(self->begin(),value);
+	while( unroll )
 	  {
-	    if( i!=self->arguments().begin() )
-	      ostr_ << ',';
-
-	    {
-	      RightExpression re( false,ostr_,(*i)->width() );
-	      (*i)->callback( re );
-	    }
+	    uint64_t c;
+	    scope_.bound()[it] =value&all;
+	    if( !scope_.fold(self->condition(),c) )
+	      unroll =false;
+	    else if( c==0 )
+	      break;
+	    else if( pass.size()>=1024 )
+	      unroll =false;
+	    else
+	      {
+		pass.push_back( value&all );
+		unroll =scope_.fold(self->reach(),value);
+	      }
 	  }
-	ostr_ << ");\n";
+	if( it!=NULL )
+	  scope_.bound().erase( it );
+	
+	if( unroll )
+	  {
+	    vector<uint64_t>::const_iterator i;
+	    for( i=pass.begin();i!=pass.end();++i )
+	      {
+		scope_.bound()[it] =*i;
+		self->statement()->callback( *this );
+	      }
+	    
+	    // the iterator is left at the value failing the condition
+	    if( pass.empty() )
+	      _assign(self->iterat(),self->begin());
+	    else
+	      {
+		scope_.bound()[it] =pass.back();
+		_assign(self->iterat(),self->reach());
+	      }
+	    scope_.bound().erase( it );
+	    return;
+	  }
+	
+	RightExpression re(scope_,comm_,ostr_,32);
+	_assign(self->iterat(),self->begin());
+	ostr_ << setw(indent_) << "" << "while( ";
+	re.truth( self->condition() );
+	ostr_ << " )\n";
+	ostr_ << setw(indent_) << "" << "  {\n";indent_+=4;
+	self->statement()->callback( *this );
+	_assign(self->iterat(),self->reach());
+	indent_-=4;ostr_ << setw(indent_) << "" << "  }\n";
+      }
+
+      void trap(const CallTask* self)
+      {
+	ostr_ << setw(indent_) << "" << "{\n";indent_+=2;
+	
+	//	ostr_ << setw(indent_) << "" << self->name() << "(";
+	ostr_ << setw(indent_) << "" << (&self->name().c_str()[1]) << "(";
+
+	vector<Expression*>::const_iterator i;
+	for( i=self->arguments().begin();i!=self->arguments().end();++i )
+	  {
+	    if( i!=self->arguments().begin() )
+	      ostr_ << ',';
+
+	    {
+	      RightExpression re( scope_,false,ostr_,(*i)->width() );
+	      (*i)->callback( re );
+	    }
+	  }
+	ostr_ << ");\n";
 
 	indent_-=2;ostr_ << setw(indent_) << "" << "}\n";
       }
@@ -1173,317 +2969,2912 @@ namespace moe
     
     
     ////////////////////////////////////////////////////////////////////////
+    // a lane word of an expression in the bit parallel mode, where every
+    // bit of a net is an uint64_t holding 64 independent vectors.
+    class LaneExpression : public Callback
+    {
+      Scope        scope_;
+      ostream&     ostr_;
+      unsigned int bit_;
+    public:
+      LaneExpression(ostream& ostr,unsigned int bit):
+	ostr_(ostr),
+	bit_(bit)
+      {}
+      ~LaneExpression(){}
+      
+      static void printLane(ostream& ostr,char type,const Net* net,unsigned int bit)
+      {
+	ostr << type << ident(net);
+	if( net->width()>1 )
+	  ostr << '[' << bit << ']';
+      }
+      static void lane(ostream& ostr,const Expression* expr,unsigned int bit)
+      {
+	LaneExpression le(ostr,bit);
+	expr->callback( le );
+      }
+      // the lanes where an expression is not zero
+      static void truth(ostream& ostr,const Expression* expr)
+      {
+	unsigned int i;
+	if( expr->width()>1 )
+	  ostr << '(';
+	for( i=0;i<expr->width();i++ )
+	  {
+	    if( i!=0 )
+	      ostr << '|';
+	    lane(ostr,expr,i);
+	  }
+	if( expr->width()>1 )
+	  ostr << ')';
+      }
+      // the lanes where two expressions differ, with don't care bits of
+      // a partial number left out.
+      static void differ(ostream& ostr,const Expression* left,const Expression* right)
+      {
+	const Number* num =NULL;
+	if( typeid( *right )==typeid( Number ) )
+	  num =(const Number*)right;
+	
+	unsigned int width =max( left->width(),right->width() );
+	unsigned int i;
+	bool second =false;
+	ostr << '(';
+	for( i=0;i<width;i++ )
+	  {
+	    if( (num!=NULL)&&num->isPartial()&&(i<num->width())&&
+		(num->mask()[num->width()-1-i]=='0') )
+	      continue;
+	    if( second )
+	      ostr << '|';
+	    ostr << '(';
+	    lane(ostr,left,i);
+	    ostr << '^';
+	    lane(ostr,right,i);
+	    ostr << ')';
+	    second =true;
+	  }
+	if( !second )
+	  ostr << "0ULL";
+	ostr << ')';
+      }
+      void failure(const char* what)
+      {
+	if( bit_==0 )
+	  std::cerr << " a " << what << " in bitparallel mode is failure profit. \n";
+	ostr_ << "0ULL";
+      }
+      
+      void trap(const String* self)
+      {
+	failure("string");
+      }
+      void trap(const Number* self)
+      {
+	if( (bit_<self->width())&&(self->value()[self->width()-1-bit_]=='1') )
+	  ostr_ << "~0ULL";
+	else
+	  ostr_ << "0ULL";
+      }
+      void trap(const Identifier* self)
+      {
+	const Net* net =self->net();
+	unsigned int lsb;
+	unsigned int width;
+	
+	if( net->isArray() )
+	  {
+	    failure("memory");
+	    return;
+	  }
+	if( scope_.dynamic(self->idx())||scope_.dynamic(self->lsb()) )
+	  {
+	    failure("variable select");
+	    return;
+	  }
+	
+	if( self->idx()!=NULL )
+	  {
+	    lsb   =scope_.select(self->idx())-base(net);
+	    width =1;
+	  }
+	else if( self->msb()!=NULL && self->lsb()!=NULL )
+	  {
+	    lsb   =scope_.select(self->lsb())-base(net);
+	    width =self->width();
+	  }
+	else
+	  {
+	    lsb   =0;
+	    width =net->width();
+	  }
+	
+	if( bit_>=width )
+	  ostr_ << "0ULL";
+	else if( net->type()==Net::PARAMETER )
+	  ostr_ << (((net->calcConstant()>>(lsb+bit_))&1) ? "~0ULL" : "0ULL");
+	else
+	  printLane(ostr_,'n',net,lsb+bit_);
+      }
+      void trap(const Concat* self)
+      {
+	if( bit_>=self->width() )
+	  {
+	    ostr_ << "0ULL";
+	    return;
+	  }
+	
+	unsigned int bit =bit_;
+	if( self->repeat()!=NULL )
+	  bit %=self->width()/self->repeat()->calcConstant();
+	
+	vector<Expression*>::const_reverse_iterator i;
+	for( i=self->list().rbegin();i!=self->list().rend();++i )
+	  {
+	    if( bit<(*i)->width() )
+	      {
+		lane(ostr_,*i,bit);
+		return;
+	      }
+	    bit -=(*i)->width();
+	  }
+      }
+      void trap(const Event* self)
+      {
+	failure("event expression");
+      }
+      void trap(const Unary* self)
+      {
+	switch( self->operation() )
+	  {
+	  case Expression::BitwiseNegation:
+	    if( bit_<self->value()->width() )
+	      {
+		ostr_ << "(~";
+		lane(ostr_,self->value(),bit_);
+		ostr_ << ')';
+	      }
+	    else
+	      ostr_ << "0ULL";
+	    break;
+	  case Expression::CastSigned:
+	  case Expression::CastUnsigned:
+	    lane(ostr_,self->value(),bit_);
+	    break;
+	  case Expression::LogicalNegation:
+	  case Expression::ReductionAND:
+	  case Expression::ReductionOR:
+	  case Expression::ReductionXOR:
+	  case Expression::ReductionNAND:
+	  case Expression::ReductionNOR:
+	  case Expression::ReductionNXOR:
+	    {
+	      if( bit_!=0 )
+		{
+		  ostr_ << "0ULL";
+		  break;
+		}
+	      
+	      char op ='|';
+	      bool neg =false;
+	      switch( self->operation() )
+		{
+		case Expression::ReductionNAND:
+		  neg =true;
+		  // fall through
+		case Expression::ReductionAND:
+		  op ='&';
+		  break;
+		case Expression::ReductionNXOR:
+		  neg =true;
+		  // fall through
+		case Expression::ReductionXOR:
+		  op ='^';
+		  break;
+		case Expression::LogicalNegation:
+		case Expression::ReductionNOR:
+		  neg =true;
+		  break;
+		}
+	      
+	      ostr_ << (neg ? "(~(" : "((");
+	      unsigned int i;
+	      for( i=0;i<self->value()->width();i++ )
+		{
+		  if( i!=0 )
+		    ostr_ << op;
+		  lane(ostr_,self->value(),i);
+		}
+	      ostr_ << "))";
+	    }
+	    break;
+	  default:
+	    failure("arithmetic expression");
+	    break;
+	  }
+      }
+      void trap(const Binary* self)
+      {
+	switch( self->operation() )
+	  {
+	  case Expression::BitwiseAND:
+	  case Expression::BitwiseOR:
+	  case Expression::BitwiseXOR:
+	    ostr_ << '(';
+	    lane(ostr_,self->left(),bit_);
+	    ostr_ << ((self->operation()==Expression::BitwiseAND) ? '&' :
+		      (self->operation()==Expression::BitwiseOR)  ? '|' : '^');
+	    lane(ostr_,self->right(),bit_);
+	    ostr_ << ')';
+	    break;
+	  case Expression::BitwiseNOR:
+	  case Expression::BitwiseNXOR:
+	    if( bit_<self->width() )
+	      {
+		ostr_ << "(~(";
+		lane(ostr_,self->left(),bit_);
+		ostr_ << ((self->operation()==Expression::BitwiseNOR) ? '|' : '^');
+		lane(ostr_,self->right(),bit_);
+		ostr_ << "))";
+	      }
+	    else
+	      ostr_ << "0ULL";
+	    break;
+	    
+	  case Expression::LeftShift:
+	  case Expression::RightShift:
+	    if( !self->right()->isConstant() )
+	      failure("variable shift");
+	    else
+	      {
+		unsigned int n =self->right()->calcConstant();
+		if( self->operation()==Expression::RightShift )
+		  lane(ostr_,self->left(),bit_+n);
+		else if( bit_>=n )
+		  lane(ostr_,self->left(),bit_-n);
+		else
+		  ostr_ << "0ULL";
+	      }
+	    break;
+	    
+	  case Expression::LogicalAND:
+	  case Expression::LogicalOR:
+	    if( bit_!=0 )
+	      ostr_ << "0ULL";
+	    else
+	      {
+		ostr_ << '(';
+		truth(ostr_,self->left());
+		ostr_ << ((self->operation()==Expression::LogicalAND) ? '&' : '|');
+		truth(ostr_,self->right());
+		ostr_ << ')';
+	      }
+	    break;
+	    
+	  case Expression::LogicalEquality:
+	  case Expression::CaseEquality:
+	    if( bit_!=0 )
+	      ostr_ << "0ULL";
+	    else
+	      {
+		ostr_ << "(~";
+		differ(ostr_,self->left(),self->right());
+		ostr_ << ')';
+	      }
+	    break;
+	  case Expression::LogicalInequality:
+	  case Expression::CaseInequality:
+	    if( bit_!=0 )
+	      ostr_ << "0ULL";
+	    else
+	      differ(ostr_,self->left(),self->right());
+	    break;
+	    
+	  default:
+	    failure("arithmetic expression");
+	    break;
+	  }
+      }
+      void trap(const Ternary* self)
+      {
+	ostr_ << "((";
+	truth(ostr_,self->condition());
+	ostr_ << '&';
+	lane(ostr_,self->trueValue(),bit_);
+	ostr_ << ")|(~";
+	truth(ostr_,self->condition());
+	ostr_ << '&';
+	lane(ostr_,self->falseValue(),bit_);
+	ostr_ << "))";
+      }
+      void trap(const CallFunction* self)
+      {
+	failure("call function expression");
+      }
+    };
+    
+    
     ////////////////////////////////////////////////////////////////////////
-    class Handle
+    // statements in the bit parallel mode. a branch becomes a lane mask
+    // m<depth>, and an assignment under a mask keeps the other lanes.
+    class LaneSplice : public Callback
+    {
+      Scope    scope_;
+      bool     comm_;
+      ostream& ostr_;
+      const set<const Net*>& flipflop_;
+      unsigned int indent_;
+      unsigned int depth_;
+      
+      void printMask()
+      {
+	if( depth_>0 )
+	  ostr_ << 'm' << depth_ << '&';
+      }
+      void assign(const Net* net,unsigned int bit,unsigned int product)
+      {
+	char type =(flipflop_.find( net )!=flipflop_.end()) ? 'd' : 'n';
+	
+	ostr_ << setw(indent_) << "";
+	LaneExpression::printLane(ostr_,type,net,bit);
+	ostr_ << " =";
+	if( depth_>0 )
+	  {
+	    ostr_ << '(';
+	    LaneExpression::printLane(ostr_,type,net,bit);
+	    ostr_ << "&~m" << depth_ << ")|(preproduct[" << product << "]&m" << depth_ << ')';
+	  }
+	else
+	  ostr_ << "preproduct[" << product << ']';
+	ostr_ << ";\n";
+      }
+      void left(const Expression* expr,unsigned int product)
+      {
+	if( typeid( *expr )==typeid( Concat ) )
+	  {
+	    const Concat* self =(const Concat*)expr;
+	    if( self->repeat()!=NULL )
+	      std::cerr << " a repeat expression in this left value is failure profit. \n";
+	    
+	    vector<Expression*>::const_reverse_iterator i;
+	    for( i=self->list().rbegin();i!=self->list().rend();++i )
+	      {
+		left(*i,product);
+		product +=(*i)->width();
+	      }
+	  }
+	else if( typeid( *expr )==typeid( Identifier ) )
+	  {
+	    const Identifier* self =(const Identifier*)expr;
+	    const Net* net =self->net();
+	    unsigned int lsb =0;
+	    
+	    if( net->isArray()||(net->type()==Net::FUNCTION) )
+	      {
+		std::cerr << " a memory or function in bitparallel mode is failure profit. \n";
+		return;
+	      }
+	    if( scope_.dynamic(self->idx())||scope_.dynamic(self->lsb()) )
+	      {
+		std::cerr << " a variable select in bitparallel mode is failure profit. \n";
+		return;
+	      }
+	    
+	    if( self->idx()!=NULL )
+	      lsb =scope_.select(self->idx())-base(net);
+	    else if( self->msb()!=NULL && self->lsb()!=NULL )
+	      lsb =scope_.select(self->lsb())-base(net);
+	    
+	    unsigned int i;
+	    for( i=0;i<self->width();i++ )
+	      assign(net,lsb+i,product+i);
+	  }
+	else
+	  std::cerr << " a expression in this left value is failure profit. \n";
+      }
+    public:
+      LaneSplice(bool comm,ostream& ostr,const set<const Net*>& flipflop,unsigned int indent,unsigned int depth=0):
+	comm_(comm),
+	ostr_(ostr),
+	flipflop_(flipflop),
+	indent_(indent),
+	depth_(depth)
+      {}
+      ~LaneSplice(){}
+      
+      void trap(const EventStatement* self)
+      {
+	std::cerr << "a event statement in this handle is failure profit. \n";
+      }
+      void trap(const Block* self)
+      {
+	ostr_ << setw(indent_) << "" << "{\n";indent_+=2;
+	
+	vector<Statement*>::const_iterator i;
+	for( i=self->list().begin();i!=self->list().end();++i )
+	  (*i)->callback( *this );
+	
+	indent_-=2;ostr_ << setw(indent_) << "" << "}\n";
+      }
+      void trap(const Condition* self)
+      {
+	unsigned int d =depth_+1;
+	
+	ostr_ << setw(indent_) << "" << "{\n";indent_+=2;
+	ostr_ << setw(indent_) << "" << "uint64_t c" << d << " =";
+	LaneExpression::truth(ostr_,self->expression());
+	ostr_ << ";\n";
+	
+	ostr_ << setw(indent_) << "" << "uint64_t m" << d << " =";
+	printMask();
+	ostr_ << 'c' << d << ";\n";
+	depth_++;
+	self->trueStatement()->callback( *this );
+	depth_--;
+	
+	if( self->falseStatement()!=NULL )
+	  {
+	    ostr_ << setw(indent_) << "" << 'm' << d << " =";
+	    printMask();
+	    ostr_ << "~c" << d << ";\n";
+	    depth_++;
+	    self->falseStatement()->callback( *this );
+	    depth_--;
+	  }
+	indent_-=2;ostr_ << setw(indent_) << "" << "}\n";
+      }
+      void trap(const Case* self)
+      {
+	unsigned int d =depth_+1;
+	unsigned int i;
+	
+	ostr_ << setw(indent_) << "" << "{\n";indent_+=2;
+	for( i=0;i<self->expression()->width();i++ )
+	  {
+	    ostr_ << setw(indent_) << "" << "uint64_t s" << d << '_' << i << " =";
+	    LaneExpression::lane(ostr_,self->expression(),i);
+	    ostr_ << ";\n";
+	  }
+	ostr_ << setw(indent_) << "" << "uint64_t h" << d << " =0;\n";
+	ostr_ << setw(indent_) << "" << "uint64_t m" << d << ";\n";
+	
+	vector<Case::Item*>::const_iterator ii;
+	for( ii=self->items().begin();ii!=self->items().end();++ii )
+	  {
+	    ostr_ << setw(indent_) << "" << 'm' << d << " =";
+	    printMask();
+	    ostr_ << "~h" << d;
+	    if( !(*ii)->expression().empty() )
+	      {
+		ostr_ << "&(";
+		vector<Expression*>::const_iterator iii;
+		for( iii=(*ii)->expression().begin();iii!=(*ii)->expression().end();++iii )
+		  {
+		    const Number* num =NULL;
+		    if( typeid( *(*iii) )==typeid( Number ) )
+		      num =(const Number*)(*iii);
+		    
+		    if( iii!=(*ii)->expression().begin() )
+		      ostr_ << '|';
+		    ostr_ << "~(0ULL";
+		    for( i=0;i<max( self->expression()->width(),(*iii)->width() );i++ )
+		      {
+			if( (num!=NULL)&&num->isPartial()&&(i<num->width())&&
+			    (num->mask()[num->width()-1-i]=='0') )
+			  continue;
+			ostr_ << "|(";
+			if( i<self->expression()->width() )
+			  ostr_ << 's' << d << '_' << i;
+			else
+			  ostr_ << "0ULL";
+			ostr_ << '^';
+			LaneExpression::lane(ostr_,*iii,i);
+			ostr_ << ')';
+		      }
+		    ostr_ << ')';
+		  }
+		ostr_ << ')';
+	      }
+	    ostr_ << ";\n";
+	    ostr_ << setw(indent_) << "" << 'h' << d << " |=m" << d << ";\n";
+	    
+	    depth_++;
+	    (*ii)->statement()->callback( *this );
+	    depth_--;
+	  }
+	indent_-=2;ostr_ << setw(indent_) << "" << "}\n";
+      }
+      void trap(const Case::Item* self)
+      {
+	std::cerr << "a case-item statement in this callback is failure profit. \n";
+      }
+      void trap(const Assign* self)
+      {
+	unsigned int width =self->leftValue()->width();
+	unsigned int i;
+	
+	ostr_ << setw(indent_) << "" << "{\n";indent_+=2;
+	ostr_ << setw(indent_) << "" << "uint64_t  preproduct[" << width << "];\n";
+	for( i=0;i<width;i++ )
+	  {
+	    ostr_ << setw(indent_) << "" << "preproduct[" << i << "] =";
+	    LaneExpression::lane(ostr_,self->rightValue(),i);
+	    ostr_ << ";\n";
+	  }
+	left(self->leftValue(),0);
+	indent_-=2;ostr_ << setw(indent_) << "" << "}\n";
+      }
+      void trap(const CallTask* self)
+      {
+	std::cerr << "a task in bitparallel mode is failure profit. \n";
+      }
+    };
+    
+    
+    ////////////////////////////////////////////////////////////////////////
+    // walks a statement in evaluation order, a net read after the
+    // statement has written it is late.
+    class OrderChainCB : public Callback
+    {
+      set<const Net*> written_;
+      set<const Net*> late_;
+      bool            left_;
+      bool            call_;
+    public:
+      OrderChainCB():
+	left_(false),
+	call_(false)
+      {}
+      ~OrderChainCB(){}
+      
+      bool isLate(const Net* net) const { return call_||(late_.find( net )!=late_.end()); }
+      
+      void trap(const Assign* self)
+      {
+	self->rightValue()->callback( *this );
+	left_ =true;
+	self->leftValue()->callback( *this );
+	left_ =false;
+      }
+      // a branch sees the writes before the branch, not of the others.
+      void trap(const Condition* self)
+      {
+	self->expression()->callback( *this );
+	set<const Net*> before =written_;
+	self->trueStatement()->callback( *this );
+	if( self->falseStatement()!=NULL )
+	  {
+	    set<const Net*> taken =written_;
+	    written_ =before;
+	    self->falseStatement()->callback( *this );
+	    written_.insert( taken.begin(),taken.end() );
+	  }
+      }
+      void trap(const Case* self)
+      {
+	self->expression()->callback( *this );
+	set<const Net*> before =written_;
+	set<const Net*> taken =written_;
+	
+	vector<Case::Item*>::const_iterator i;
+	for( i=self->items().begin();i!=self->items().end();++i )
+	  {
+	    written_ =before;
+	    (*i)->callback( *this );
+	    taken.insert( written_.begin(),written_.end() );
+	  }
+	written_ =taken;
+      }
+      void trap(const For* self)
+      {
+	// the second pass reads the writes of the former iteration.
+	self->statement()->callback( *this );
+	self->statement()->callback( *this );
+      }
+      void trap(const CallFunction* self)
+      {
+	Callback::trap( self );
+	call_ |=!written_.empty();
+      }
+      void trap(const CallTask* self)
+      {
+	vector<Expression*>::const_iterator i;
+	for( i=self->arguments().begin();i!=self->arguments().end();++i )
+	  (*i)->callback( *this );
+	call_ |=!written_.empty();
+      }
+      void trap(const Identifier* self)
+      {
+	bool left =left_;
+	left_ =false;
+	if( self->msb()!=NULL )
+	  self->msb()->callback( *this );
+	if( self->lsb()!=NULL )
+	  self->lsb()->callback( *this );
+	if( self->idx()!=NULL )
+	  self->idx()->callback( *this );
+	left_ =left;
+	
+	if( self->net()==NULL )
+	  return;
+	if( left_ )
+	  written_.insert( self->net() );
+	else if( written_.find( self->net() )!=written_.end() )
+	  late_.insert( self->net() );
+      }
+    };
+    ////////////////////////////////////////////////////////////////////////
+    // the iterators of the loops in a statement, written by no chain.
+    class IteratorCB : public Callback
+    {
+      set<const Net*>& iterator_;
+    public:
+      IteratorCB(set<const Net*>& iterator):
+	iterator_(iterator)
+      {}
+      ~IteratorCB(){}
+      
+      void trap(const For* self)
+      {
+	if( self->iterat()->net()!=NULL )
+	  iterator_.insert( self->iterat()->net() );
+	self->statement()->callback( *this );
+      }
+    };
+    ////////////////////////////////////////////////////////////////////////
+    // the pure subexpressions of a domain method. an occurrence is keyed
+    // by its text in the context it is printed in, so equal keys are one
+    // value of one C++ type while no net it reads changes in the method.
+    // divides and calls are left in place, hoisted they would run where
+    // their statement does not.
+    class CommonCB : public Callback
+    {
+    public:
+      struct Temp
+      {
+	const Expression*         expr;
+	unsigned int              cast;
+	const char*               type;
+	vector<const Expression*> use;
+      };
+    private:
+      Scope&                 scope_;
+      const set<const Net*>& dirty_;
+      unsigned int           cast_;
+      map<string,unsigned int> key_;
+      vector<Temp>           temp_;
+      
+      // true when the expression is pure and reads no dirty net
+      bool _walk(const Expression* expr)
+      {
+	uint64_t value;
+	if( expr->width()>64 )
+	  return false;
+	if( scope_.fold(expr,value) )
+	  return true;
+	
+	if( typeid( *expr )==typeid( Number ) )
+	  return true;
+	if( typeid( *expr )==typeid( Identifier ) )
+	  {
+	    const Identifier* id =(const Identifier*)expr;
+	    if( (id->net()==NULL)||(dirty_.find( id->net() )!=dirty_.end()) )
+	      return false;
+	    if( id->net()->isArray() )
+	      return _walk(id->idx());
+	    if( scope_.dynamic(id->idx())||scope_.dynamic(id->lsb()) )
+	      return _walk((id->idx()!=NULL) ? id->idx() : id->lsb());
+	    return true;
+	  }
+	if( typeid( *expr )==typeid( Concat ) )
+	  {
+	    bool pure =true;
+	    vector<Expression*>::const_iterator i;
+	    for( i=((const Concat*)expr)->list().begin();i!=((const Concat*)expr)->list().end();++i )
+	      pure &=_walk(*i);
+	    return pure;
+	  }
+	if( typeid( *expr )==typeid( Ternary ) )
+	  {
+	    const Ternary* t =(const Ternary*)expr;
+	    if( scope_.fold(t->condition(),value) )
+	      return _walk((value!=0) ? t->trueValue() : t->falseValue());
+	    bool pure =_walk(t->condition());
+	    pure &=_walk(t->trueValue());
+	    pure &=_walk(t->falseValue());
+	    return pure;
+	  }
+	
+	const char* type =NULL;
+	if( typeid( *expr )==typeid( Unary ) )
+	  {
+	    const Unary* u =(const Unary*)expr;
+	    if( !_walk(u->value()) )
+	      return false;
+	    switch( u->operation() )
+	      {
+	      case Expression::LogicalNegation:
+	      case Expression::ReductionAND:
+	      case Expression::ReductionOR:
+	      case Expression::ReductionXOR:
+	      case Expression::ReductionNAND:
+	      case Expression::ReductionNOR:
+	      case Expression::ReductionNXOR:
+		type ="bool";
+		break;
+	      case Expression::BitwiseNegation:
+		type ="uint64_t";// masked by an unsigned long
+		break;
+	      }
+	  }
+	else if( typeid( *expr )==typeid( Binary ) )
+	  {
+	    const Binary* b =(const Binary*)expr;
+	    bool pure =_walk(b->left());
+	    pure &=_walk(b->right());
+	    if( !pure )
+	      return false;
+	    switch( b->operation() )
+	      {
+	      case Expression::ArithmeticAdd:
+	      case Expression::ArithmeticMinus:
+	      case Expression::ArithmeticMultiply:
+		type =(cast_<=32) ? "uint32_t" : "uint64_t";
+		break;
+	      case Expression::BitwiseNOR:
+	      case Expression::BitwiseNXOR:
+		type ="uint64_t";
+		break;
+	      case Expression::LogicalEquality:
+	      case Expression::LogicalInequality:
+	      case Expression::LogicalAND:
+	      case Expression::LogicalOR:
+	      case Expression::LessThan:
+	      case Expression::GreaterThan:
+	      case Expression::LessEqual:
+	      case Expression::GreaterEqual:
+	      case Expression::CaseEquality:
+	      case Expression::CaseInequality:
+		type ="bool";
+		break;
+	      case Expression::LeftShift:
+	      case Expression::RightShift:
+		// computed ahead, a shift by an amount known at run time may go
+		// past the word where its statement would not have run
+		if( !scope_.fold(b->right(),value) )
+		  return false;
+		break;
+	      case Expression::BitwiseAND:
+	      case Expression::BitwiseOR:
+	      case Expression::BitwiseXOR:
+		break;
+	      default:
+		return false;
+	      }
+	  }
+	else
+	  return false;
+	
+	if( type!=NULL )
+	  {
+	    ostringstream text;
+	    RightExpression re(scope_,false,text,cast_);
+	    expr->callback( re );
+	    
+	    pair<map<string,unsigned int>::iterator,bool> k;
+	    k =key_.insert( pair<string,unsigned int>(text.str(),temp_.size()) );
+	    if( k.second )
+	      {
+		temp_.push_back( Temp() );
+		temp_.back().expr =expr;
+		temp_.back().cast =cast_;
+		temp_.back().type =type;
+	      }
+	    temp_[k.first->second].use.push_back( expr );
+	  }
+	return true;
+      }
+    public:
+      CommonCB(Scope& scope,const set<const Net*>& dirty):
+	scope_(scope),
+	dirty_(dirty),
+	cast_(32)
+      {}
+      ~CommonCB(){}
+      
+      // the keys repeated, an operand before the expressions holding it
+      void common(vector<Temp>& temp) const
+      {
+	vector<Temp>::const_iterator i;
+	for( i=temp_.begin();i!=temp_.end();++i )
+	  if( i->use.size()>1 )
+	    temp.push_back( *i );
+      }
+      // a narrow context prints the same text at any width of its class
+      void root(const Expression* expr,unsigned int cast)
+      {
+	if( cast>64 )
+	  return;
+	cast_ =(cast<=32) ? 32 : 64;
+	_walk(expr);
+      }
+      
+      void trap(const Block* self)
+      {
+	vector<Statement*>::const_iterator i;
+	for( i=self->list().begin();i!=self->list().end();++i )
+	  (*i)->callback( *this );
+      }
+      void trap(const Condition* self)
+      {
+	uint64_t c;
+	if( scope_.fold(self->expression(),c) )
+	  {
+	    if( c!=0 )
+	      self->trueStatement()->callback( *this );
+	    else if( self->falseStatement()!=NULL )
+	      self->falseStatement()->callback( *this );
+	    return;
+	  }
+	root(self->expression(),32);
+	self->trueStatement()->callback( *this );
+	if( self->falseStatement()!=NULL )
+	  self->falseStatement()->callback( *this );
+      }
+      void trap(const Case* self)
+      {
+	uint64_t value;
+	const Case::Item* hit;
+	if( scope_.fold(self->expression(),value)&&scope_.choose(self,value,hit) )
+	  {
+	    if( (hit!=NULL)&&(hit->statement()!=NULL) )
+	      hit->statement()->callback( *this );
+	    return;
+	  }
+	root(self->expression(),32);
+	
+	vector<Case::Item*>::const_iterator i;
+	for( i=self->items().begin();i!=self->items().end();++i )
+	  if( (*i)->statement()!=NULL )
+	    (*i)->statement()->callback( *this );
+      }
+      void trap(const Assign* self)
+      {
+	root(self->rightValue(),self->leftValue()->width());
+      }
+      void trap(const For* self)
+      {
+      }
+      void trap(const CallTask* self)
+      {
+      }
+    };
+    
+    
+    ////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////////////
+    // a scheduled reference to a node.
+    class Handle
+    {
+      unsigned int index_;
+    public:
+      Handle():
+	index_(0)
+      {}
+      ~Handle(){}
+      explicit Handle(unsigned int index):
+	index_(index)
+      {}
+      unsigned int index() const { return index_; }
+    };
+    ////////////////////////////////////////////////////////////////////////
+    // the net chains of a statement, held once by the design graph.
+    // a node without statement but with members is a latch loop group.
+    class Node
+    {
+      const Statement*  stat_;
+      const Expression* gate_;
+      set<const Net*>   left_;
+      set<const Net*>   right_;
+      vector<Handle>    member_;
+      
+
+    public:
+      Node():
+	stat_(NULL),
+	gate_(NULL)
+      {}
+      ~Node(){}
+      Node(const Statement* stat,const Expression* gate=NULL):
+	stat_(stat),
+	gate_(gate)
+      {}
+      set<const Net*>& left()  { return left_; }
+      set<const Net*>& right() { return right_; }
+      const Statement* statement()  const { return stat_; }
+      const Expression* gate() const { return gate_; }
+      const set<const Net*>& left()  const { return left_; }
+      const set<const Net*>& right() const { return right_; }
+      vector<Handle>& member() { return member_; }
+      const vector<Handle>& member() const { return member_; }
+    };
+    ////////////////////////////////////////////////////////////////////////
+    class Synchronous
+    {
+      set<const Net*>   syncnet_;
+      const Net*   net_;
+      int          type_;
+      bool         derived_;
+      list<Handle> handle_;
+    public:
+      void dump(ostream &ostr,const deque<Node>& node)
+      {
+	list<Handle>::const_iterator i;
+	for( i=handle_.begin();i!=handle_.end();++i )
+	  if( node[(*i).index()].statement()!=NULL )
+	    node[(*i).index()].statement()->toVerilog( ostr ,0 );
+      }
+      
+      ~Synchronous(){}
+      Synchronous():
+	net_(NULL),
+	derived_(false)
+      {}
+      Synchronous(const Net* net,int type,bool derived=false):
+	net_(net),
+	type_(type),
+	derived_(derived)
+      {}
+      const Net* net() const { return net_; }
+      int type() const { return type_; }
+      bool isDerived() const { return derived_; }
+      list<Handle>& handle() { return handle_; }
+      const list<Handle>& handle() const { return handle_; }
+
+      void setSyncNet(const Net* net) { syncnet_.insert(net); }
+      const set<const Net*>& syncNet() const { return syncnet_; }
+    };
+    
+    
+    ////////////////////////////////////////////////////////////////////////
+    Module* top_;
+    
+    vector<Synchronous*> sync_;
+    Synchronous*         anysync_;
+    
+    set<const Net*> syncsrc_;
+    set<const Net*> latch_;
+    set<const Net*> flipflop_;
+    set<const Net*> shadow_;  // the flip-flops with a shadow in the method being printed
+    
+    multimap<const Net*,const Statement*> map_;
+    
+    deque<Node>                        node_;  // stays put while it grows
+    map<const Statement*,unsigned int> index_;
+    
+    map<const Net*,unsigned int>       netLevel_;
+    map<const Statement*,unsigned int> statLevel_;
+    
+    Metrics metrics_;
+    bool    lane_;
+    unsigned int batch_;
+    unsigned int threads_;
+    unsigned int shard_;
+    unsigned int sparse_;
+    bool         mux_;
+    unsigned int inline_;
+    
+    map<string,vector<vector<Handle> > > piece_;  // method, the pieces it is cut into
+    set<const Net*>                      spill_;  // private nets its pieces share
+    vector<string::size_type>            cut_;    // where the methods begin in the source
+    
+    bool                                activity_;
+    map<unsigned int,unsigned int>      cone_;    // node index, cone
+    map<const Net*,set<unsigned int> >  reader_;  // net, cones reading it
+    set<const Net*>                     sense_;   // read by cones, written by none
+    
+    //    map<const Net*,const Assign*>    constant_;
+    
+    ////////////////////////////////////////////////////////////////////////
+    const Node& node(const Handle& handle) const { return node_[handle.index()]; }
+    ////////////////////////////////////
+    Handle newNode(const Statement* stat,const Expression* gate=NULL)
+    {
+      node_.push_back( Node(stat,gate) );
+      return Handle( node_.size()-1 );
+    }
+    ////////////////////////////////////
+    // the left and right chains of a combinational statement are shared
+    // by every domain which relates it.
+    Handle findNode(const Statement* stat)
+    {
+      map<const Statement*,unsigned int>::const_iterator i;
+      i =index_.find( stat );
+      if( i!=index_.end() )
+	return Handle( i->second );
+      
+      Handle handle =newNode( stat );
+      index_.insert( pair<const Statement*,unsigned int>(stat,handle.index()) );
+      
+      LeftNetChainCB  lcb( node_[handle.index()].left() );
+      RightNetChainCB rcb( node_[handle.index()].right() );
+      stat->callback( lcb );
+      stat->callback( rcb );
+      return handle;
+    }
+    ////////////////////////////////////////////////////////////////////////
+    static bool _plain(const Expression* expr)
+    {
+      if( typeid( *expr )==typeid( Identifier ) )
+	{
+	  const Identifier* id =(const Identifier*)expr;
+	  if( (id->msb()==NULL)&&(id->lsb()==NULL)&&(id->idx()==NULL) )
+	    return true;
+	}
+      return false;
+    }
+    ////////////////////////////////////
+    // a continuous assignment which forwards the edges of net :
+    //   alias    (y =clk)      same edge
+    //   inverter (y =~clk)     opposite edge
+    //   gate     (y =clk & en) same edge while en is true
+    static bool _forward(const Assign* ass,const Net* net,int& type,const Expression*& gate)
+    {
+      if( !ass->isSimpleLeft() )
+	return false;
+      
+      const Expression* rval =ass->rightValue();
+      if( _plain(rval) )
+	return ( rval->net()==net );
+      
+      if( typeid( *rval )==typeid( Unary ) )
+	{
+	  const Unary* u =(const Unary*)rval;
+	  if( ((u->operation()==Expression::BitwiseNegation)||
+	       (u->operation()==Expression::LogicalNegation))&&
+	      _plain(u->value())&&(u->value()->net()==net) )
+	    {
+	      type =(type==Event::POSEDGE) ? Event::NEGEDGE : Event::POSEDGE;
+	      return true;
+	    }
+	}
+      else if( typeid( *rval )==typeid( Binary ) )
+	{
+	  const Binary* b =(const Binary*)rval;
+	  if( (b->operation()==Expression::BitwiseAND)||
+	      (b->operation()==Expression::LogicalAND) )
+	    {
+	      const Expression* en =NULL;
+	      if( _plain(b->left())&&(b->left()->net()==net) )
+		en =b->right();
+	      else if( _plain(b->right())&&(b->right()->net()==net) )
+		en =b->left();
+	      
+	      if( en!=NULL )
+		{
+		  if( gate!=NULL )
+		    std::cerr << "\nnested clock gate is failure profit. \n";
+		  else
+		    gate =en;
+		  return true;
+		}
+	    }
+	}
+      return false;
+    }
+    ////////////////////////////////////////////////////////////////////////
+    // the statement a clock edge runs in an always block which also has
+    // an asynchronous set or reset. the level of the set or reset is kept
+    // in a member, so the clock runs the whole body and its test holds
+    // the flip-flops while the level is active.
+    static const Statement* _held(const Process* proc,const Net* net,const Statement* stat)
+    {
+      const EventStatement* es =(const EventStatement*)proc->statement();
+      if( es->event().size()<2 )
+	return stat;
+      
+      set<const Net*> read;
+      RightNetChainCB cb( read );
+      es->statement()->callback( cb );
+      if( read.find( net )!=read.end() )
+	return stat;
+      return es->statement();
+    }
+    void _trace(const Net* net,int type,const Expression* gate,
+		Synchronous* sync,int& curr,int& total)
+    {
+      total +=top_->process().size();
+      if( total==0 )
+	printProgress(std::cerr,100.0);
+      else
+	printProgress(std::cerr,(100.0*curr)/total);
+
+      sync->setSyncNet( net );
+
+      vector<Process*>::const_iterator i;
+      for( i=top_->process().begin();i!=top_->process().end();++i )
+	{
+	  curr ++;
+	  
+	  if( typeid( *((*i)->statement()) )==typeid( Assign ) )
+	    {
+	      Assign* ass=(Assign*)(*i)->statement();
+	      int               t =type;
+	      const Expression* g =gate;
+	      
+	      if( _forward(ass,net,t,g) )
+		_trace(((Identifier*)ass->leftValue())->net(),t,g,sync,curr,total);
+	    }
+	  else
+	    {
+	      const Statement* stat;
+	      stat =(*i)->queryStatement(type,net);
+	      if( (stat!=NULL)&&!lane_&&(batch_==0) )
+		stat =_held(*i,net,stat);
+	      if( stat!=NULL )
+		{
+		  Handle handle =newNode(stat,gate);
+		  set<const Net*>& right =node_[handle.index()].right();
+		  RightNetChainCB cb( right );
+		  stat->callback( cb );
+		  if( gate!=NULL )
+		    gate->chain( right );
+
+		  sync->handle().push_back( handle );
+		}
+	    }
+	}
+
+    }
+    bool trace(const Net* net,int type,Synchronous* sync)
+    {
+      printProgress(std::cerr,-1);
+      int curr=0;
+      int total=0;
+
+      _trace(net,type,NULL,sync,curr,total);
+      
+      printProgress(std::cerr,100.0);
+      return true;
+    }
+    ////////////////////////////////////////////////////////////////////////
+    // true if every path through stat assigns the whole net.
+    static bool _complete(const Statement* stat,const Net* net)
+    {
+      if( stat==NULL )
+	return false;
+      
+      if( typeid( *stat )==typeid( Assign ) )
+	{
+	  const Expression* lval =((const Assign*)stat)->leftValue();
+	  if( _plain(lval) )
+	    return ( lval->net()==net );
+	  if( typeid( *lval )==typeid( Concat ) )
+	    {
+	      vector<Expression*>::const_iterator i;
+	      for( i=((const Concat*)lval)->list().begin();i!=((const Concat*)lval)->list().end();++i )
+		if( _plain(*i)&&((*i)->net()==net) )
+		  return true;
+	    }
+	}
+      else if( typeid( *stat )==typeid( Block ) )
+	{
+	  vector<Statement*>::const_iterator i;
+	  for( i=((const Block*)stat)->list().begin();i!=((const Block*)stat)->list().end();++i )
+	    if( _complete(*i,net) )
+	      return true;
+	}
+      else if( typeid( *stat )==typeid( Condition ) )
+	{
+	  const Condition* c =(const Condition*)stat;
+	  return _complete(c->trueStatement(),net)&&_complete(c->falseStatement(),net);
+	}
+      else if( typeid( *stat )==typeid( Case ) )
+	{
+	  bool def =false;
+	  vector<Case::Item*>::const_iterator i;
+	  for( i=((const Case*)stat)->items().begin();i!=((const Case*)stat)->items().end();++i )
+	    {
+	      if( (*i)->expression().empty() )
+		def =true;
+	      if( !_complete((*i)->statement(),net) )
+		return false;
+	    }
+	  return def;
+	}
+      return false;
+    }
+    ////////////////////////////////////
+    // true if a clock source is read as a level by the combinational logic,
+    // not counting the clock tree itself.
+    bool _level(const Net* net) const
+    {
+      vector<Process*>::const_iterator i;
+      for( i=top_->process().begin();i!=top_->process().end();++i )
+	if( !(*i)->isEdge() )
+	  if( (*i)->rightChain().find( net )!=(*i)->rightChain().end() )
+	    {
+	      if( typeid( *((*i)->statement()) )==typeid( Assign ) )
+		{
+		  int               type =Event::POSEDGE;
+		  const Expression* gate =NULL;
+		  if( _forward((const Assign*)(*i)->statement(),net,type,gate) )
+		    continue;
+		}
+	      return true;
+	    }
+      return false;
+    }
+    ////////////////////////////////////
+    // true if an edge source is read as data by the always blocks it
+    // triggers : an asynchronous set or reset rather than a clock.
+    bool _asynchronous(const Net* net)
+    {
+      vector<Process*>::const_iterator i;
+      for( i=top_->process().begin();i!=top_->process().end();++i )
+	if( ((*i)->type()==Process::ALWAYS)&&(*i)->isEdge()&&
+	    (typeid( *((*i)->statement()) )==typeid( EventStatement )) )
+	  {
+	    const EventStatement* es =(const EventStatement*)(*i)->statement();
+	    set<const Net*> read;
+	    RightNetChainCB cb( read );
+	    es->statement()->callback( cb );
+	    
+	    vector<Event*>::const_iterator ii;
+	    for( ii=es->event().begin();ii!=es->event().end();++ii )
+	      if( _plain((*ii)->expression())&&(read.find( (*ii)->expression()->net() )!=read.end()) )
+		{
+		  int type =(*ii)->type();
+		  if( _source((*ii)->expression()->net(),type,syncsrc_)==net )
+		    return true;
+		}
+	  }
+      return false;
+    }
+    ////////////////////////////////////////////////////////////////////////
+    // follow a clock net backward through aliases, inverters and gates
+    // to the net which really makes the edge.
+    const Net* _source(const Net* net,int& type,const set<const Net*>& clock)
+    {
+      set<const Net*> visit;
+      
+      while( visit.insert(net).second )
+	{
+	  multimap<const Net*,const Statement*>::const_iterator i;
+	  i =map_.find( net );
+	  if( (i==map_.end())||(map_.count( net )!=1) )
+	    break;
+	  if( typeid( *(i->second) )!=typeid( Assign ) )
+	    break;
+	  
+	  const Assign*     ass =(const Assign*)i->second;
+	  const Expression* rval =ass->rightValue();
+	  const Net*        src =NULL;
+	  int               t;
+	  const Expression* g;
+	  
+	  vector<const Expression*> cand;
+	  if( typeid( *rval )==typeid( Unary ) )
+	    cand.push_back( ((const Unary*)rval)->value() );
+	  else if( typeid( *rval )==typeid( Binary ) )
+	    {
+	      cand.push_back( ((const Binary*)rval)->left() );
+	      cand.push_back( ((const Binary*)rval)->right() );
+	    }
+	  else
+	    cand.push_back( rval );
+	  
+	  // a gate made from two nets : prefer the one which clocks something
+	  // else, and then the one which is not a storage (a latched enable).
+	  vector<const Expression*>::const_iterator ii;
+	  for( ii=cand.begin();ii!=cand.end();++ii )
+	    {
+	      t =type;
+	      g =NULL;
+	      if( _plain(*ii)&&_forward(ass,(*ii)->net(),t,g) )
+		{
+		  const Net* n =(*ii)->net();
+		  if( src==NULL )
+		    src =n;
+		  else if( (clock.find(n)!=clock.end())&&(clock.find(src)==clock.end()) )
+		    src =n;
+		  else if( (clock.find(n)==clock.end())&&(clock.find(src)==clock.end())&&
+			   (latch_.find(src)!=latch_.end())&&(latch_.find(n)==latch_.end()) )
+		    src =n;
+		}
+	    }
+	  if( src==NULL )
+	    break;
+	  
+	  t =type;
+	  g =NULL;
+	  _forward(ass,src,t,g);
+	  type =t;
+	  net  =src;
+	}
+      return net;
+    }
+    ////////////////////////////////////////////////////////////////////////
+    void _relate(const Net* net,
+		 set<const Net*>& actnet,
+		 set<const Statement*>& actstat,
+		 list<Handle>& chain)
+    {
+      if( actnet.find(net)==actnet.end() )
+	{
+	  actnet.insert( net );
+	  
+	  multimap<const Net*,const Statement*>::const_iterator i;
+	  set<const Net*>::const_iterator ii;
+	  i =map_.find( net );
+	  if( i!=map_.end() )
+	    {
+	      do
+		{
+		  if( actstat.find( i->second )==actstat.end() )
+		    {
+		      actstat.insert( i->second );
+		      
+		      Handle handle =findNode( i->second );
+		      chain.push_front( handle );
+		      
+		      const set<const Net*>& right =node( handle ).right();
+		      for( ii=right.begin();ii!=right.end();++ii )
+			_relate(*ii,actnet,actstat,chain);
+		    }
+		  i++;
+		}
+	      while( i!=map_.upper_bound( net ) );
+	    }
+	}
+    }
+    ////////////////////////////////////
+    bool relate(list<Handle>& chain)
+    {
+      set<const Net*> actnet;
+      
+      set<const Statement*> actstat;
+      list<Handle>::const_iterator i;
+      set<const Net*>::const_iterator ii;
+      
+      double per =0.0;
+      double step =100.0/chain.size();
+      
+      printProgress(std::cerr,-1);
+      for( i=chain.begin();i!=chain.end();++i )
+	{
+	  printProgress(std::cerr,per);
+	  per +=step;
+	  
+	  for( ii=node(*i).right().begin();ii!=node(*i).right().end();++ii )
+	    _relate(*ii,actnet,actstat,chain);
+	}
+      printProgress(std::cerr,100.0);
+      
+      return true;
+    }
+    ////////////////////////////////////////////////////////////////////////
+    bool _inclusion(const set<const Net*>& l,const set<const Net*>& r)
+    {
+      set<const Net*>::const_iterator i;
+      for( i=l.begin();i!=l.end();++i )
+	if( r.find( *i )!=r.end() )
+	  return true;
+      return false; 
+    }
+    ////////////////////////////////////
+    bool inspect(list<Handle>& chain)
+    {
+      list<Handle>::iterator i;
+      list<Handle>::iterator ii;
+      
+      double per =0.0;
+      double step =100.0/chain.size();
+      printProgress(std::cerr,-1);
+      for( i=chain.begin();i!=chain.end();++i )
+	{
+	  printProgress(std::cerr,per);
+	  per +=step;
+	  
+	  for( ii=i;ii!=chain.end();++ii )
+	    {
+	      if( i!=ii )
+		if( _inclusion( node(*i).right(),node(*ii).left() ) )
+		  {
+		    chain.insert( i,(*ii) );
+		    chain.erase( ii );
+		    return true;
+		  }
+	    }
+	}
+      printProgress(std::cerr,100.0);
+      
+      return false;
+    }
+    ////////////////////////////////////
+    // the strongly connected loops of a chain which write a latch are
+    // folded into a single group node, evaluated to a fixed point.
+    int group(list<Handle>& chain)
+    {
+      vector<Handle> handle( chain.begin(),chain.end() );
+      int n =handle.size();
+      
+      vector< vector<int> > edge(n);
+      {
+	multimap<const Net*,int> writer;
+	set<const Net*>::const_iterator ii;
+	int i;
+	for( i=0;i<n;i++ )
+	  for( ii=node(handle[i]).left().begin();ii!=node(handle[i]).left().end();++ii )
+	    writer.insert( pair<const Net*,int>(*ii,i) );
+	
+	for( i=0;i<n;i++ )
+	  for( ii=node(handle[i]).right().begin();ii!=node(handle[i]).right().end();++ii )
+	    {
+	      multimap<const Net*,int>::const_iterator w;
+	      for( w=writer.lower_bound(*ii);w!=writer.upper_bound(*ii);++w )
+		if( w->second!=i )
+		  edge[i].push_back( w->second );
+	    }
+      }
+      
+      // tarjan, without recursion.
+      vector<int> index(n,-1);
+      vector<int> low(n,0);
+      vector<int> comp(n,-1);
+      vector<bool> stacked(n,false);
+      vector<int> stack;
+      vector< pair<int,unsigned int> > call;
+      int count =0;
+      int ncomp =0;
+      int root;
+      for( root=0;root<n;root++ )
+	{
+	  if( index[root]>=0 )
+	    continue;
+	  call.push_back( pair<int,unsigned int>(root,0) );
+	  while( !call.empty() )
+	    {
+	      int v =call.back().first;
+	      if( call.back().second==0 )
+		{
+		  index[v] =low[v] =count++;
+		  stack.push_back( v );
+		  stacked[v] =true;
+		}
+	      if( call.back().second<edge[v].size() )
+		{
+		  int w =edge[v][call.back().second++];
+		  if( index[w]<0 )
+		    call.push_back( pair<int,unsigned int>(w,0) );
+		  else if( stacked[w] )
+		    low[v] =min( low[v],index[w] );
+		  continue;
+		}
+	      if( low[v]==index[v] )
+		{
+		  int w;
+		  do
+		    {
+		      w =stack.back();
+		      stack.pop_back();
+		      stacked[w] =false;
+		      comp[w] =ncomp;
+		    }
+		  while( w!=v );
+		  ncomp++;
+		}
+	      call.pop_back();
+	      if( !call.empty() )
+		low[call.back().first] =min( low[call.back().first],low[v] );
+	    }
+	}
+      
+      vector<int> size(ncomp,0);
+      vector<bool> latch(ncomp,false);
+      {
+	int i;
+	for( i=0;i<n;i++ )
+	  {
+	    size[comp[i]]++;
+	    if( _inclusion( node(handle[i]).left(),latch_ ) )
+	      latch[comp[i]] =true;
+	  }
+      }
+      
+      int ret =0;
+      map<int,Handle> folded;
+      chain.clear();
+      {
+	int i;
+	for( i=0;i<n;i++ )
+	  {
+	    int c =comp[i];
+	    if( (size[c]<2)||!latch[c] )
+	      {
+		chain.push_back( handle[i] );
+		continue;
+	      }
+	    
+	    map<int,Handle>::const_iterator f =folded.find(c);
+	    if( f==folded.end() )
+	      {
+		Handle g =newNode(NULL);
+		folded.insert( pair<int,Handle>(c,g) );
+		chain.push_back( g );
+		f =folded.find(c);
+		ret++;
+	      }
+	    
+	    Node& g =node_[f->second.index()];
+	    g.member().push_back( handle[i] );
+	    g.left().insert( node(handle[i]).left().begin(),node(handle[i]).left().end() );
+	    g.right().insert( node(handle[i]).right().begin(),node(handle[i]).right().end() );
+	  }
+      }
+      
+      return ret;
+    }
+    ////////////////////////////////////
+    bool sort(list<Handle>& chain)
+    {
+      bool swap;
+      set<unsigned int> loop;
+      list<Handle>::iterator i;
+      list<Handle>::iterator ii;
+      
+      double per =0.0;
+      double step =100.0/chain.size();
+      
+      printProgress(std::cerr,-1);
+      for( i=chain.begin();i!=chain.end();++i )
+	{
+	  printProgress(std::cerr,per);
+	  per +=step;
+	  
+	  do
+	    {
+	      for( ii=i;ii!=chain.end();++ii )
+		{
+		  swap=false;
+		  if( i!=ii )
+		    if( _inclusion( node(*i).right(),node(*ii).left() ) )
+		      {
+			if( loop.find( (*ii).index() )!=loop.end() )
+			  {
+			    std::cerr << "\nlacing error !\n";
+			    if( node(*ii).statement()!=NULL )
+			      node(*ii).statement()->toVerilog(cerr,0);
+			    
+			    return false;
+			  }
+			
+			loop.insert( (*ii).index() );
+			
+			i =chain.insert( i,(*ii) );
+			chain.erase( ii );
+			
+			swap=true;
+			break;
+		      }
+		  if( swap )
+		    break;
+		}
+	    }
+	  while( swap );
+	  loop.clear();
+	}
+      
+      printProgress(std::cerr,100.0);
+      
+      return true;
+    }
+    ////////////////////////////////////////////////////////////////////////
+    // combinational depth : a net without a combinational driver is on
+    // level 0, a statement is one above the deepest net it reads.
+    unsigned int _levelize(const Net* net,set<const Net*>& active)
+    {
+      map<const Net*,unsigned int>::const_iterator l =netLevel_.find( net );
+      if( l!=netLevel_.end() )
+	return l->second;
+      if( !active.insert( net ).second )
+	return 0; // a latch loop is cut here
+      
+      unsigned int ret =0;
+      multimap<const Net*,const Statement*>::const_iterator i;
+      for( i=map_.lower_bound( net );i!=map_.upper_bound( net );++i )
+	{
+	  unsigned int level;
+	  map<const Statement*,unsigned int>::const_iterator s =statLevel_.find( i->second );
+	  if( s!=statLevel_.end() )
+	    level =s->second;
+	  else
+	    {
+	      set<const Net*> left;
+	      set<const Net*> right;
+	      LeftNetChainCB  lcb( left );
+	      RightNetChainCB rcb( right );
+	      i->second->callback( lcb );
+	      i->second->callback( rcb );
+	      
+	      level =0;
+	      set<const Net*>::const_iterator ii;
+	      for( ii=right.begin();ii!=right.end();++ii )
+		if( left.find( *ii )==left.end() )
+		  level =max( level,_levelize(*ii,active) );
+	      level++;
+	      statLevel_.insert( pair<const Statement*,unsigned int>(i->second,level) );
+	    }
+	  ret =max( ret,level );
+	}
+      
+      active.erase( net );
+      netLevel_.insert( pair<const Net*,unsigned int>(net,ret) );
+      return ret;
+    }
+    void levelize()
+    {
+      netLevel_.clear();
+      statLevel_.clear();
+      
+      multimap<const Net*,const Statement*>::const_iterator i;
+      for( i=map_.begin();i!=map_.end();i=map_.upper_bound( i->first ) )
+	{
+	  set<const Net*> active;
+	  _levelize(i->first,active);
+	}
+    }
+    ////////////////////////////////////
+    unsigned int level(const Handle& handle) const
+    {
+      const Node& n =node(handle);
+      if( !n.member().empty() )
+	{
+	  unsigned int ret =0;
+	  vector<Handle>::const_iterator i;
+	  for( i=n.member().begin();i!=n.member().end();++i )
+	    ret =max( ret,level(*i) );
+	  return ret;
+	}
+      if( n.statement()==NULL )
+	return 0;
+      
+      map<const Statement*,unsigned int>::const_iterator s =statLevel_.find( n.statement() );
+      if( s!=statLevel_.end() )
+	return s->second;
+      
+      unsigned int ret =0;
+      set<const Net*>::const_iterator i;
+      for( i=n.right().begin();i!=n.right().end();++i )
+	ret =max( ret,level(*i) );
+      return ret+1;
+    }
+    ////////////////////////////////////////////////////////////////////////
+    bool grouped() const
+    {
+      deque<Node>::const_iterator i;
+      for( i=node_.begin();i!=node_.end();++i )
+	if( !(*i).member().empty() )
+	  return true;
+      return false;
+    }
+    bool wide() const
+    {
+      WideCB cb;
+      top_->callback( cb );
+      return cb.wide();
+    }
+    ////////////////////////////////////
+    // the nets a scheduled handle writes and reads.
+    void _touch(const Handle& handle,set<const Net*>& left,set<const Net*>& right) const
+    {
+      const Node& n =node(handle);
+      
+      vector<Handle>::const_iterator i;
+      for( i=n.member().begin();i!=n.member().end();++i )
+	_touch(*i,left,right);
+      
+      if( n.statement()!=NULL )
+	{
+	  LeftNetChainCB cb( left );
+	  n.statement()->callback( cb );
+	}
+      right.insert( n.right().begin(),n.right().end() );
+    }
+    static unsigned int _root(vector<unsigned int>& root,unsigned int k)
+    {
+      while( root[k]!=k )
+	{
+	  root[k] =root[root[k]];
+	  k =root[k];
+	}
+      return k;
+    }
+    ////////////////////////////////////
+    // splits the scheduled handles into weakly connected clusters, two
+    // handles joined when one writes a net the other touches. reading a
+    // flip-flop joins nothing, since its writes go to the data shadow.
+    // the clusters are packed by their count of nets into parts, the
+    // largest first onto the lightest part.
+    vector<unsigned int> partition(const vector<Handle>& chain,unsigned int parts) const
+    {
+      vector< set<const Net*> > left( chain.size() );
+      vector< set<const Net*> > right( chain.size() );
+      vector<unsigned int>      root( chain.size() );
+      map<const Net*,unsigned int> writer;
+      unsigned int k;
+      
+      for( k=0;k<chain.size();k++ )
+	{
+	  _touch(chain[k],left[k],right[k]);
+	  root[k] =k;
+	}
+      
+      for( k=0;k<chain.size();k++ )
+	{
+	  set<const Net*>::const_iterator i;
+	  for( i=left[k].begin();i!=left[k].end();++i )
+	    {
+	      map<const Net*,unsigned int>::const_iterator w =writer.find( *i );
+	      if( w!=writer.end() )
+		root[_root(root,k)] =_root(root,w->second);
+	      else
+		writer.insert( pair<const Net*,unsigned int>(*i,k) );
+	    }
+	}
+      for( k=0;k<chain.size();k++ )
+	{
+	  set<const Net*>::const_iterator i;
+	  for( i=right[k].begin();i!=right[k].end();++i )
+	    if( flipflop_.find(*i)==flipflop_.end() )
+	      {
+		map<const Net*,unsigned int>::const_iterator w =writer.find( *i );
+		if( w!=writer.end() )
+		  root[_root(root,k)] =_root(root,w->second);
+	      }
+	}
+      
+      map<unsigned int,unsigned int> cost;
+      for( k=0;k<chain.size();k++ )
+	cost[_root(root,k)] +=left[k].size()+right[k].size()+1;
+      
+      vector< pair<unsigned int,unsigned int> > order;
+      {
+	map<unsigned int,unsigned int>::const_iterator i;
+	for( i=cost.begin();i!=cost.end();++i )
+	  order.push_back( pair<unsigned int,unsigned int>(i->second,i->first) );
+      }
+      std::sort( order.rbegin(),order.rend() );
+      
+      vector<unsigned int>           load( parts,0 );
+      map<unsigned int,unsigned int> bin;
+      {
+	vector< pair<unsigned int,unsigned int> >::const_iterator i;
+	for( i=order.begin();i!=order.end();++i )
+	  {
+	    unsigned int p =min_element( load.begin(),load.end() )-load.begin();
+	    bin[i->second] =p;
+	    load[p] +=i->first;
+	  }
+      }
+      
+      if( metrics_.report() )
+	{
+	  std::cerr << "partition : " << order.size() << " clusters,";
+	  for( k=0;k<parts;k++ )
+	    std::cerr << ' ' << load[k];
+	  std::cerr << '\n';
+	}
+      
+      vector<unsigned int> ret( chain.size() );
+      for( k=0;k<chain.size();k++ )
+	ret[k] =bin[_root(root,k)];
+      return ret;
+    }
+    ////////////////////////////////////
+    // one part of a domain : its clocked handles, the flip-flop commit
+    // and its level handles, lined up with the other parts by barriers.
+    void printPart(ostream& ccstr,int indent,bool comm,const string& name,unsigned int part,
+		   const vector<Handle>& chain,const vector<unsigned int>& bin,unsigned int clocked)
+    {
+      set<const Net*> left;
+      set<const Net*> right;
+      set<const Net*> shadow;
+      unsigned int k;
+      for( k=0;k<chain.size();k++ )
+	if( bin[k]==part )
+	  {
+	    set<const Net*> l;
+	    set<const Net*> r;
+	    _touch(chain[k],l,r);
+	    left.insert( l.begin(),l.end() );
+	    right.insert( r.begin(),r.end() );
+	    
+	    set<const Net*>::const_iterator i;
+	    if( k<clocked )
+	      for( i=l.begin();i!=l.end();++i )
+		if( flipflop_.find(*i)!=flipflop_.end() )
+		  shadow.insert( *i );
+	  }
+      
+      Scope scope =newScope();
+      ccstr << setw(indent) << "" << "void ";
+      ccstr << findName( top_ ) << "::" << name << '_' << part << "()\n";
+      ccstr << setw(indent) << "" << '{' << endl;indent+=2;
+      {
+	map<string,Net*>::const_iterator i;
+	for( i=top_->net().begin();i!=top_->net().end();++i )
+	  if( (left.find(i->second)!=left.end())||(right.find(i->second)!=right.end()) )
+	    {
+	      if( flipflop_.find(i->second)!=flipflop_.end() )
+		{
+		  if( shadow.find(i->second)!=shadow.end() )
+		    printShadow(ccstr,indent,comm,i->first,i->second);
+		}
+	      else if( (i->second->interface()==Net::PRIVATE)&&
+		       (latch_.find(i->second)==latch_.end()) )
+		printLocal(ccstr,indent,comm,i->first,i->second);
+	    }
+      }
+      
+      for( k=0;k<clocked;k++ )
+	if( bin[k]==part )
+	  splice(ccstr,scope,chain[k],comm,indent);
+      
+      if( clocked>0 )
+	{
+	  ccstr << setw(indent) << "" << "pool_.barrier();\n";
+	  set<const Net*>::const_iterator i;
+	  for( i=shadow.begin();i!=shadow.end();++i )
+	    printCommit(ccstr,indent,*i);
+	  ccstr << setw(indent) << "" << "pool_.barrier();\n";
+	}
+      
+      for( k=clocked;k<chain.size();k++ )
+	if( bin[k]==part )
+	  splice(ccstr,scope,chain[k],comm,indent);
+      
+      indent-=2;ccstr << setw(indent) << "" << '}' << endl;
+    }
+    ////////////////////////////////////
+    // the parts of a domain and the job which hands them to the workers.
+    void printParts(ostream& ccstr,int indent,bool comm,const string& name,const Synchronous* sync)
+    {
+      vector<Handle> chain;
+      unsigned int   clocked =0;
+      if( sync!=NULL )
+	{
+	  chain.insert( chain.end(),sync->handle().begin(),sync->handle().end() );
+	  clocked =chain.size();
+	}
+      chain.insert( chain.end(),anysync_->handle().begin(),anysync_->handle().end() );
+      
+      vector<unsigned int> bin =partition(chain,threads_);
+      
+      unsigned int k;
+      for( k=0;k<threads_;k++ )
+	{
+	  printPart(ccstr,indent,comm,name,k,chain,bin,clocked);
+	  printCut(ccstr,indent);
+	}
+      
+      ccstr << setw(indent) << "" << "void ";
+      ccstr << findName( top_ ) << "::" << name << "_job(void* self,uint32_t part)\n";
+      ccstr << setw(indent) << "" << "{\n";
+      ccstr << setw(indent+2) << "" << "switch( part )\n";
+      ccstr << setw(indent+2) << "" << "  {\n";
+      for( k=0;k<threads_;k++ )
+	ccstr << setw(indent+2) << "" << "  case " << k << ": ((" << findName( top_ ) << "*)self)->"
+	      << name << '_' << k << "(); break;\n";
+      ccstr << setw(indent+2) << "" << "  }\n";
+      ccstr << setw(indent) << "" << "}\n";
+      printCut(ccstr,indent);
+    }
+    ////////////////////////////////////
+    string _event(const Synchronous* sync) const
+    {
+      string name =top_->findName( sync->net() );
+      if( sync->type()==Event::POSEDGE )
+	name +="_posedge";
+      else if( sync->type()==Event::NEGEDGE )
+	name +="_negedge";
+      else
+	name +="_anyedge";
+      return name;
+    }
+    ////////////////////////////////////
+    // a method begins here, a file of the source may start with it.
+    void printCut(ostream& ccstr,int indent)
+    {
+      cut_.push_back( ccstr.tellp() );
+      ccstr << setw(indent) << "" << "////////////////////////////////////////////////////////////////////////\n";
+    }
+    ////////////////////////////////////
+    // writes the source. with a shard size the methods, from the cuts
+    // made where each begins, are packed in order into files of that
+    // size, each opening the namespace again; a method over the size
+    // takes a file alone. files a run with more shards left are removed,
+    // a build globbing them would link their methods twice.
+    void printShards(const string& path,const string& text,string::size_type tail) const
+    {
+      string name =path+findName( top_ );
+      string::size_type head =cut_.empty() ? tail : cut_.front();
+      
+      vector<string> file( 1 );
+      unsigned int k;
+      for( k=0;k<cut_.size();k++ )
+	{
+	  string::size_type next =(k+1<cut_.size()) ? cut_[k+1] : tail;
+	  if( (shard_>0)&&!file.back().empty()&&(file.back().size()+(next-cut_[k])>shard_*1024UL) )
+	    file.push_back( string() );
+	  file.back() +=text.substr( cut_[k],next-cut_[k] );
+	}
+      
+      for( k=0;;k++ )
+	{
+	  std::ostringstream fname;
+	  fname << name;
+	  if( k>0 )
+	    fname << '_' << k;
+	  fname << ".cc";
+	  
+	  if( k<file.size() )
+	    {
+	      std::ofstream ccstr(fname.str().c_str());
+	      ccstr << text.substr( 0,head ) << file[k] << text.substr( tail );
+	    }
+	  else if( std::remove(fname.str().c_str())!=0 )
+	    break;
+	}
+      if( shard_>0 )
+	std::cerr << "shard : " << file.size() << " files\n";
+    }
+    ////////////////////////////////////
+    // the size a handle takes printed.
+    unsigned long _size(const Handle& handle,bool comm)
+    {
+      std::ostringstream ccstr;
+      Scope scope =newScope();
+      splice(ccstr,scope,handle,comm,4);
+      return ccstr.str().size();
+    }
+    ////////////////////////////////////
+    // a method whose handles and locals print over the shard size is cut
+    // into pieces of that size, in order, each a method of its own the
+    // method calls. a piece declares only the locals it touches.
+    void slice(const string& name,const list<Handle>& handle,bool comm,unsigned long locals)
+    {
+      vector<vector<Handle> > piece( 1 );
+      unsigned long size =0;
+      unsigned long total =locals;
+      list<Handle>::const_iterator i;
+      for( i=handle.begin();i!=handle.end();++i )
+	{
+	  unsigned long s =_size(*i,comm);
+	  if( !piece.back().empty()&&(size+s>shard_*1024UL) )
+	    {
+	      piece.push_back( vector<Handle>() );
+	      size =0;
+	    }
+	  piece.back().push_back( *i );
+	  size +=s;
+	  total +=s;
+	}
+      if( !handle.empty()&&(total>shard_*1024UL) )
+	piece_[name] =piece;
+    }
+    bool _sliced(const string& name) const
+    {
+      return piece_.find( name )!=piece_.end();
+    }
+    // the pieces of a method, or all its handles as one when not cut.
+    vector<vector<Handle> > _units(const string& name,const list<Handle>& handle) const
+    {
+      map<string,vector<vector<Handle> > >::const_iterator i =piece_.find( name );
+      if( i!=piece_.end() )
+	return i->second;
+      return vector<vector<Handle> >( 1,vector<Handle>( handle.begin(),handle.end() ) );
+    }
+    ////////////////////////////////////
+    // a private net more units of a method touch is kept in the class, a
+    // local lives in one piece only. the dump reads every one of them.
+    void _spill(const vector<vector<Handle> >& unit,bool vcd)
+    {
+      map<const Net*,unsigned int> count;
+      vector<vector<Handle> >::const_iterator i;
+      for( i=unit.begin();i!=unit.end();++i )
+	{
+	  set<const Net*> touch;
+	  vector<Handle>::const_iterator ii;
+	  for( ii=i->begin();ii!=i->end();++ii )
+	    _touch(*ii,touch,touch);
+	  
+	  set<const Net*>::const_iterator iii;
+	  for( iii=touch.begin();iii!=touch.end();++iii )
+	    {
+	      uint64_t value;
+	      if( ((++count[*iii]==2)||vcd)&&((*iii)->interface()==Net::PRIVATE)&&
+		  ((*iii)->type()!=Net::PARAMETER)&&!isMember( *iii )&&!newScope().folded(*iii,value) )
+		spill_.insert( *iii );
+	    }
+	}
+    }
+    ////////////////////////////////////
+    // cuts the domains and the level logic over the shard size, before
+    // the header declares their pieces. a domain runs its clocked handles
+    // then the level ones, the nets its pieces share are spilled.
+    void slices(bool comm,bool vcd)
+    {
+      if( (shard_==0)||lane_||(batch_>0)||(threads_>0) )
+	return;
+      
+      std::ostringstream ccstr;
+      map<string,Net*>::const_iterator ii;
+      for( ii=top_->net().begin();ii!=top_->net().end();++ii )
+	if( (ii->second->interface()==Net::PRIVATE)&&
+	    (flipflop_.find(ii->second)==flipflop_.end())&&(latch_.find(ii->second)==latch_.end()) )
+	  printLocal(ccstr,4,comm,ii->first,ii->second);
+      
+      shadow_ =flipflop_;
+      vector<Synchronous*>::const_iterator i;
+      for( i=sync_.begin();i!=sync_.end();++i )
+	slice(_event(*i),(*i)->handle(),comm,ccstr.str().size());
+      slice("_level",anysync_->handle(),comm,ccstr.str().size());
+      
+      vector<vector<Handle> > level =_units("_level",anysync_->handle());
+      for( i=sync_.begin();i!=sync_.end();++i )
+	if( _sliced(_event(*i))||_sliced("_level") )
+	  {
+	    vector<vector<Handle> > unit =_units(_event(*i),(*i)->handle());
+	    unit.insert( unit.end(),level.begin(),level.end() );
+	    _spill(unit,vcd);
+	  }
+      if( _sliced("_level") )
+	_spill(level,vcd);
+    }
+    // the flip-flops the clocked handles of a domain write.
+    void _written(const Synchronous* sync,set<const Net*>& written) const
+    {
+      set<const Net*> left;
+      set<const Net*> right;
+      list<Handle>::const_iterator i;
+      for( i=sync->handle().begin();i!=sync->handle().end();++i )
+	_touch(*i,left,right);
+      set<const Net*>::const_iterator ii;
+      for( ii=left.begin();ii!=left.end();++ii )
+	if( flipflop_.find(*ii)!=flipflop_.end() )
+	  written.insert( *ii );
+    }
+    ////////////////////////////////////
+    // the pieces of a method over the shard size. the private nets of a
+    // piece are its locals, the flip-flops write their shadow in the class.
+    void printPieces(ostream& ccstr,int indent,bool comm,const string& name)
+    {
+      const vector<vector<Handle> >& piece =piece_.find( name )->second;
+      unsigned int k;
+      for( k=0;k<piece.size();k++ )
+	{
+	  set<const Net*> touch;
+	  vector<Handle>::const_iterator i;
+	  for( i=piece[k].begin();i!=piece[k].end();++i )
+	    _touch(*i,touch,touch);
+	  
+	  Scope scope =newScope();
+	  ccstr << setw(indent) << "" << "void ";
+	  ccstr << findName( top_ ) << "::" << name << '_' << k << "()\n";
+	  ccstr << setw(indent) << "" << '{' << endl;indent+=2;
+	  map<string,Net*>::const_iterator ii;
+	  for( ii=top_->net().begin();ii!=top_->net().end();++ii )
+	    if( (touch.find(ii->second)!=touch.end())&&(ii->second->interface()==Net::PRIVATE)&&
+		(flipflop_.find(ii->second)==flipflop_.end())&&(latch_.find(ii->second)==latch_.end()) )
+	      printLocal(ccstr,indent,comm,ii->first,ii->second);
+	  for( i=piece[k].begin();i!=piece[k].end();++i )
+	    splice(ccstr,scope,*i,comm,indent);
+	  indent-=2;ccstr << setw(indent) << "" << '}' << endl;
+	  printCut(ccstr,indent);
+	}
+    }
+    void printPieceCalls(ostream& ccstr,int indent,const string& name) const
+    {
+      unsigned int k;
+      for( k=0;k<piece_.find( name )->second.size();k++ )
+	ccstr << setw(indent) << "" << name << '_' << k << "();\n";
+    }
+    ////////////////////////////////////
+    // a net kept in the class, the others live in the event methods.
+    bool isMember(const Net* net) const
     {
-      const Statement* stat_;
-      set<const Net*>  left_;
-      set<const Net*>  right_;
+      return ((syncsrc_.find( net )==syncsrc_.end())||_level(net))&&
+	((net->interface()!=Net::PRIVATE)||
+	 (flipflop_.find(net)!=flipflop_.end())||
+	 (latch_.find(net)!=latch_.end())||
+	 (spill_.find(net)!=spill_.end())||
+	 (activity_&&(net->type()!=Net::PARAMETER)));
+    }
+    ////////////////////////////////////
+    // a handle of the level logic, a statement found by its right chain
+    // or a latch loop group of them.
+    bool _combinational(const Handle& handle) const
+    {
+      const Node& n =node(handle);
+      if( !n.member().empty() )
+	return true;
+      if( n.statement()==NULL )
+	return false;
       
-
-    public:
-      Handle():
-	stat_(NULL)
-      {}
-      ~Handle(){}
-      Handle(const Statement* stat):
-	stat_(stat)
-      {}
-      void setLeft(const set<const Net*>& l) { left_=l; }
-      void setRight(const set<const Net*>& r) { right_=r; }
-      const Statement* statement()  const { return stat_; }
-      const set<const Net*>& left()  const { return left_; }
-      const set<const Net*>& right() const { return right_; }
-    };
-    ////////////////////////////////////////////////////////////////////////
-    class Synchronous
+      map<const Statement*,unsigned int>::const_iterator i =index_.find( n.statement() );
+      return (i!=index_.end())&&(i->second==handle.index());
+    }
+    ////////////////////////////////////
+    // the nets in member order : the scalars by the first handle of the
+    // schedule touching them, the memories after them, the untouched
+    // last. a private unsigned member of up to 16 bits takes the
+    // smallest word holding it.
+    void layout(vector<pair<string,Net*> >& member) const
     {
-      set<const Net*>   syncnet_;
-      const Net*   net_;
-      int          type_;
-      list<Handle> handle_;
-    public:
-      void dump(ostream &ostr)
+      map<const Net*,unsigned int> first;
       {
-	list<Handle>::const_iterator i;
-	for( i=handle_.begin();i!=handle_.end();++i )
-	  (*i).statement()->toVerilog( ostr ,0 );
+	vector<const list<Handle>*> chain;
+	vector<Synchronous*>::const_iterator i;
+	for( i=sync_.begin();i!=sync_.end();++i )
+	  chain.push_back( &(*i)->handle() );
+	chain.push_back( &anysync_->handle() );
+	
+	unsigned int k =0;
+	vector<const list<Handle>*>::const_iterator ii;
+	for( ii=chain.begin();ii!=chain.end();++ii )
+	  {
+	    list<Handle>::const_iterator iii;
+	    for( iii=(*ii)->begin();iii!=(*ii)->end();++iii,++k )
+	      {
+		set<const Net*> touch;
+		_touch(*iii,touch,touch);
+		set<const Net*>::const_iterator n;
+		for( n=touch.begin();n!=touch.end();++n )
+		  first.insert( pair<const Net*,unsigned int>(*n,k) );
+	      }
+	  }
       }
       
-      ~Synchronous(){}
-      Synchronous():
-	net_(NULL)
-      {}
-      Synchronous(const Net* net,int type):
-	net_(net),
-	type_(type)
-      {}
-      const Net* net() const { return net_; }
-      int type() const { return type_; }
-      list<Handle>& handle() { return handle_; }
-      const list<Handle>& handle() const { return handle_; }
-
-      void setSyncNet(const Net* net) { syncnet_.insert(net); }
-      const set<const Net*>& syncNet() const { return syncnet_; }
-    };
-    
-    
-    ////////////////////////////////////////////////////////////////////////
-    Module* top_;
-    
-    vector<Synchronous*> sync_;
-    Synchronous*         anysync_;
-    
-    set<const Net*> syncsrc_;
-    set<const Net*> latch_;
-    set<const Net*> flipflop_;
-    
-    multimap<const Net*,const Statement*> map_;
-    
-    //    map<const Net*,const Assign*>    constant_;
-    
-    ////////////////////////////////////////////////////////////////////////
-    void _trace(const Net* net,int type,Synchronous* sync,int& curr,int& total)
-    {
-      total +=top_->process().size();
-      if( total==0 )
-	printProgress(std::cerr,100.0);
-      else
-	printProgress(std::cerr,(100.0*curr)/total);
-
-      sync->setSyncNet( net );
-
-      vector<Process*>::const_iterator i;
-      for( i=top_->process().begin();i!=top_->process().end();++i )
+      multimap<pair<bool,unsigned int>,pair<string,Net*> > order;
+      map<string,Net*>::const_iterator i;
+      for( i=top_->net().begin();i!=top_->net().end();++i )
 	{
-	  curr ++;
+	  map<const Net*,unsigned int>::const_iterator f =first.find( i->second );
+	  unsigned int k =(f!=first.end()) ? f->second : first.size()+1;
+	  order.insert( pair<pair<bool,unsigned int>,pair<string,Net*> >
+			(pair<bool,unsigned int>(i->second->isArray(),k),*i) );
 	  
-	  if( typeid( *((*i)->statement()) )==typeid( Assign ) )
-	    {
-	      Assign* ass=(Assign*)(*i)->statement();
-	      
-	      if( ass->isSimple() )
-		if( typeid( *(ass->rightValue()) )==typeid( Identifier )&&
-		    ((Identifier*)ass->rightValue())->net()==net )
-		  _trace(((Identifier*)ass->leftValue())->net(),type,sync,curr,total);
-	    }
-	  else
+	  if( !lane_&&isMember(i->second)&&(i->second->interface()==Net::PRIVATE)&&
+	      !i->second->sign()&&(i->second->width()<=16) )
+	    narrow().insert( i->second );
+	  if( !lane_&&(batch_==0)&&(sparse_>0)&&i->second->isArray()&&
+	      (bytes(i->second)>sparse_*1024ULL) )
 	    {
-	      const Statement* stat;
-	      stat =(*i)->queryStatement(type,net);
-	      if( stat!=NULL )
-		{
-		  set<const Net*> right;
-		  RightNetChainCB cb( right );
-		  stat->callback( cb );
-
-		  Handle handle(stat);
-		  handle.setRight( right );
-		  sync->handle().push_back( handle );
-		}
+	      paged().insert( i->second );
+	      if( metrics_.report() )
+		std::cerr << "sparse : " << i->first << ' ' << i->second->depth() << " words of "
+			  << (bytes(i->second)/1024) << " kilobytes paged\n";
 	    }
 	}
-
+      
+      multimap<pair<bool,unsigned int>,pair<string,Net*> >::const_iterator ii;
+      for( ii=order.begin();ii!=order.end();++ii )
+	member.push_back( ii->second );
     }
-    bool trace(const Net* net,int type,Synchronous* sync)
+    ////////////////////////////////////
+    // the flip-flops of an edge which keep their shadow : written by more
+    // than one handle or by a loop group, read by a later handle, or read
+    // after the write in their own statement. the others are assigned in
+    // place, no reader of the edge sees the old value after the write.
+    void inplace(const Synchronous* sync,set<const Net*>& shadow) const
     {
-      printProgress(std::cerr,-1);
-      int curr=0;
-      int total=0;
-
-      sync->setSyncNet( net );
-
-      vector<Process*>::const_iterator i;
-      for( i=top_->process().begin();i!=top_->process().end();++i )
+      map<const Net*,unsigned int> writer;
+      vector<set<const Net*> >     read;
+      
+      list<Handle>::const_iterator i;
+      for( i=sync->handle().begin();i!=sync->handle().end();++i )
 	{
-	  curr ++;
+	  const Node& n =node(*i);
+	  set<const Net*> left;
+	  read.push_back( set<const Net*>() );
+	  _touch(*i,left,read.back());
 	  
-	  if( typeid( *((*i)->statement()) )==typeid( Assign ) )
+	  OrderChainCB cb;
+	  if( n.member().empty()&&(n.statement()!=NULL) )
+	    n.statement()->callback( cb );
+	  
+	  set<const Net*>::const_iterator ii;
+	  for( ii=left.begin();ii!=left.end();++ii )
+	    if( flipflop_.find(*ii)!=flipflop_.end() )
+	      {
+		if( !writer.insert( pair<const Net*,unsigned int>(*ii,read.size()-1) ).second ||
+		    !n.member().empty()||cb.isLate(*ii) )
+		  shadow.insert( *ii );
+	      }
+	}
+      
+      map<const Net*,unsigned int>::const_iterator ii;
+      for( ii=writer.begin();ii!=writer.end();++ii )
+	{
+	  unsigned int k;
+	  for( k=ii->second+1;k<read.size();k++ )
+	    if( read[k].find( ii->first )!=read[k].end() )
+	      shadow.insert( ii->first );
+	}
+      
+      if( metrics_.report() )
+	std::cerr << "in place : " << top_->findName( sync->net() ) << ' '
+		  << writer.size()-shadow.size() << " of " << writer.size() << " flip-flops\n";
+    }
+    ////////////////////////////////////
+    // the repeated subexpressions of a domain method, computed once into
+    // temporaries before its handles. a net is dirty when a handle writes
+    // it other than through its shadow.
+    void _common(const Handle& handle,CommonCB& cb) const
+    {
+      const Node& n =node(handle);
+      
+      vector<Handle>::const_iterator i;
+      for( i=n.member().begin();i!=n.member().end();++i )
+	_common(*i,cb);
+      
+      if( n.gate()!=NULL )
+	cb.root(n.gate(),32);
+      if( n.statement()!=NULL )
+	n.statement()->callback( cb );
+    }
+    void hoist(ostream& ccstr,Scope& scope,const Synchronous* sync,bool comm,int indent) const
+    {
+      set<const Net*> dirty;
+      {
+	set<const Net*> left;
+	set<const Net*> right;
+	list<Handle>::const_iterator i;
+	for( i=sync->handle().begin();i!=sync->handle().end();++i )
+	  _touch(*i,left,right);
+	
+	set<const Net*>::const_iterator ii;
+	for( ii=left.begin();ii!=left.end();++ii )
+	  if( shadow_.find(*ii)==shadow_.end() )
+	    dirty.insert( *ii );
+	
+	IteratorCB cb(dirty);
+	for( i=sync->handle().begin();i!=sync->handle().end();++i )
+	  {
+	    const Node& n =node(*i);
+	    if( n.statement()!=NULL )
+	      n.statement()->callback( cb );
+	    
+	    vector<Handle>::const_iterator ii;
+	    for( ii=n.member().begin();ii!=n.member().end();++ii )
+	      if( node(*ii).statement()!=NULL )
+		node(*ii).statement()->callback( cb );
+	  }
+      }
+      
+      CommonCB cb(scope,dirty);
+      {
+	list<Handle>::const_iterator i;
+	for( i=sync->handle().begin();i!=sync->handle().end();++i )
+	  _common(*i,cb);
+      }
+      vector<CommonCB::Temp> temp;
+      cb.common(temp);
+      
+      unsigned int use =0;
+      unsigned int k;
+      for( k=0;k<temp.size();k++ )
+	{
+	  ccstr << setw(indent) << "" << temp[k].type << ' ' << 'c' << k << " =";
+	  RightExpression re(scope,false,ccstr,temp[k].cast);
+	  temp[k].expr->callback( re );
+	  ccstr << ';';
+	  if( comm )
 	    {
-	      Assign* ass=(Assign*)(*i)->statement();
-	      
-	      if( ass->isSimple() )
-		if( typeid( *(ass->rightValue()) )==typeid( Identifier )&&
-		    ((Identifier*)ass->rightValue())->net()==net )
-		  _trace(((Identifier*)ass->leftValue())->net(),type,sync,curr,total);
+	      ccstr << " // ";
+	      temp[k].expr->toVerilog( ccstr );
 	    }
-	  else
-	    {
-	      const Statement* stat;
-	      stat =(*i)->queryStatement(type,net);
-	      if( stat!=NULL )
+	  ccstr << endl;
+	  
+	  vector<const Expression*>::const_iterator i;
+	  for( i=temp[k].use.begin();i!=temp[k].use.end();++i )
+	    scope.shared().insert( pair<const Expression*,pair<unsigned int,unsigned int> >
+				   (*i,pair<unsigned int,unsigned int>(k,temp[k].cast)) );
+	  use +=temp[k].use.size();
+	}
+      
+      if( metrics_.report() )
+	std::cerr << "common : " << top_->findName( sync->net() ) << ' '
+		  << temp.size() << " temporaries for " << use << " reads\n";
+    }
+    ////////////////////////////////////
+    // every combinational handle of the domains is a cone with a dirty
+    // flag. the nets read by cones but written by none are sensed at the
+    // entry of a chain, the others when their cone has run.
+    void cones()
+    {
+      vector<const list<Handle>*> chain;
+      {
+	vector<Synchronous*>::const_iterator i;
+	for( i=sync_.begin();i!=sync_.end();++i )
+	  chain.push_back( &(*i)->handle() );
+	chain.push_back( &anysync_->handle() );
+      }
+      
+      set<const Net*> written;
+      set<const Net*> read;
+      vector<const list<Handle>*>::const_iterator i;
+      for( i=chain.begin();i!=chain.end();++i )
+	{
+	  list<Handle>::const_iterator ii;
+	  for( ii=(*i)->begin();ii!=(*i)->end();++ii )
+	    if( _combinational(*ii)&&(cone_.find( ii->index() )==cone_.end()) )
+	      {
+		unsigned int c =cone_.size();
+		cone_.insert( pair<unsigned int,unsigned int>(ii->index(),c) );
+		
+		set<const Net*> left;
+		set<const Net*> right;
+		_touch(*ii,left,right);
+		written.insert( left.begin(),left.end() );
+		
+		set<const Net*>::const_iterator iii;
+		for( iii=right.begin();iii!=right.end();++iii )
+		  if( (*iii)->type()!=Net::PARAMETER )
+		    {
+		      reader_[*iii].insert( c );
+		      read.insert( *iii );
+		    }
+	      }
+	}
+      
+      set<const Net*>::const_iterator ii;
+      for( ii=read.begin();ii!=read.end();++ii )
+	if( (written.find(*ii)==written.end())&&isMember(*ii) )
+	  sense_.insert( *ii );
+      
+      if( metrics_.report() )
+	std::cerr << "activity : " << cone_.size() << " cones, " << sense_.size() << " sensed nets\n";
+    }
+    ////////////////////////////////////
+    void printWake(ostream& ccstr,const set<unsigned int>& cone,unsigned int self)
+    {
+      set<unsigned int>::const_iterator i;
+      for( i=cone.begin();i!=cone.end();++i )
+	if( *i!=self )
+	  ccstr << " cone_[" << *i << "] =true;";
+    }
+    ////////////////////////////////////
+    // wakes the cones of the sensed nets which changed since the last
+    // entry. a memory is not compared, its readers always run.
+    void printSense(ostream& ccstr,int indent)
+    {
+      map<string,Net*>::const_iterator i;
+      for( i=top_->net().begin();i!=top_->net().end();++i )
+	if( sense_.find(i->second)!=sense_.end() )
+	  {
+	    uintptr_t n =ident(i->second);
+	    ccstr << setw(indent) << "";
+	    if( i->second->isArray() )
+	      printWake(ccstr,reader_[i->second],cone_.size());
+	    else
+	      {
+		ccstr << "if( s" << n << "!=n" << n << " ) { s" << n << " =n" << n << ';';
+		printWake(ccstr,reader_[i->second],cone_.size());
+		ccstr << " }";
+	      }
+	    ccstr << endl;
+	  }
+    }
+    ////////////////////////////////////
+    // binds the member nets of the instance _i to their usual names.
+    void printInstance(ostream& ccstr,int indent)
+    {
+      map<string,Net*>::const_iterator i;
+      for( i=top_->net().begin();i!=top_->net().end();++i )
+	if( isMember(i->second) )
+	  {
+	    const Net* net =i->second;
+	    
+	    ccstr << setw(indent) << "";
+	    if( lane_ )
+	      ccstr << "uint64_t";
+	    else if( narrow().find( net )!=narrow().end() )
+	      ccstr << narrowClass(net);
+	    else
+	      printCast(ccstr,net->width());
+	    if( net->isArray()||(lane_&&(net->width()>1)) )
+	      {
+		ccstr << " (&n" << ident(net) << ')';
+		if( net->isArray() )
+		  ccstr << '[' << net->depth() << ']';
+		if( lane_&&(net->width()>1) )
+		  ccstr << '[' << net->width() << ']';
+	      }
+	    else
+	      ccstr << "& __restrict n" << ident(net);
+	    ccstr << " =this->n" << ident(net) << "[_i];\n";
+	  }
+    }
+    ////////////////////////////////////
+    // the asynchronous sources kept in a member of their own, when no
+    // member holds them already.
+    void _kept(vector<const Net*>& kept)
+    {
+      if( lane_||(batch_>0) )
+	return;
+      
+      vector<Synchronous*>::const_iterator i;
+      for( i=sync_.begin();i!=sync_.end();++i )
+	if( !(*i)->isDerived()&&!isMember( (*i)->net() )&&_asynchronous( (*i)->net() )&&
+	    (find( kept.begin(),kept.end(),(*i)->net() )==kept.end()) )
+	  kept.push_back( (*i)->net() );
+    }
+    ////////////////////////////////////
+    // a port the cycle records of run carry, inputs but the clocks for the
+    // stimulus, outputs for the response. an asynchronous set or reset is
+    // a level of the stimulus, its edges step its domains.
+    bool _record(const Net* net,bool input)
+    {
+      if( input )
+	return ((syncsrc_.find( net )==syncsrc_.end())||_asynchronous(net))&&
+	  ((net->interface()==Net::INPUT)||(net->interface()==Net::INOUT));
+      return (net->interface()==Net::OUTPUT)||(net->interface()==Net::INOUT);
+    }
+    // the cycle records, a field for every port, and the entry stepping
+    // many cycles in one call.
+    void printRecord(ostream& hhstr,int indent)
+    {
+      const char* name[2] ={ "Stimulus","Response" };
+      unsigned int k;
+      for( k=0;k<2;k++ )
+	{
+	  hhstr << setw(indent) << "" << "struct " << name[k] << "\n";
+	  hhstr << setw(indent) << "" << "{\n";
+	  map<string,Net*>::const_iterator i;
+	  for( i=top_->net().begin();i!=top_->net().end();++i )
+	    if( _record(i->second,k==0) )
+	      {
+		hhstr << setw(indent+2) << "";
+		if( i->second->width()<=32 )
+		  hhstr << "uint32_t   ";
+		else if( i->second->width()<=64 )
+		  hhstr << "uint64_t   ";
+		else
+		  hhstr << "UIntN<" << i->second->width() << ">  ";
+		hhstr << i->first << ";\n";
+	      }
+	  hhstr << setw(indent) << "" << "};\n";
+	}
+      hhstr << setw(indent) << "" << "void run(uint64_t cycles,const Stimulus* in,Response* out);\n";
+    }
+    // every cycle takes its stimulus, when given, steps the domains of the
+    // asynchronous sources it gives an edge, settles the level logic and
+    // steps the clocks in order, then fills its response, when asked. the
+    // clocks test the level kept, a set or reset held holds their flops.
+    void printRun(ostream& ccstr,int indent,bool anything)
+    {
+      set<const Net*> async;
+      vector<Synchronous*>::const_iterator ii;
+      for( ii=sync_.begin();ii!=sync_.end();++ii )
+	if( !(*ii)->isDerived()&&_asynchronous((*ii)->net()) )
+	  async.insert( (*ii)->net() );
+      
+      ccstr << setw(indent) << "" << "void ";
+      ccstr << findName( top_ ) << "::run(uint64_t cycles,const Stimulus* in,Response* out)\n";
+      ccstr << setw(indent) << "" << "{\n";indent+=2;
+      ccstr << setw(indent) << "" << "uint64_t c;\n";
+      ccstr << setw(indent) << "" << "for( c=0;c<cycles;c++ )\n";
+      ccstr << setw(indent) << "" << "  {\n";indent+=4;
+      
+      map<string,Net*>::const_iterator i;
+      ccstr << setw(indent) << "" << "if( in!=NULL )\n";
+      ccstr << setw(indent) << "" << "  {\n";
+      for( i=top_->net().begin();i!=top_->net().end();++i )
+	if( _record(i->second,true)&&(async.find( i->second )==async.end()) )
+	  ccstr << setw(indent+4) << "" << 'n' << ident(i->second) << " =in[c]." << i->first << ";\n";
+      for( i=top_->net().begin();i!=top_->net().end();++i )
+	if( async.find( i->second )!=async.end() )
+	  {
+	    uintptr_t n =ident(i->second);
+	    printTypedNet(ccstr,indent+4,'p',i->second);
+	    ccstr << 'p' << n << " =n" << n << ";\n";
+	    ccstr << setw(indent+4) << "" << 'n' << n << " =in[c]." << i->first << ";\n";
+	    for( ii=sync_.begin();ii!=sync_.end();++ii )
+	      if( !(*ii)->isDerived()&&((*ii)->net()==i->second) )
 		{
-		  set<const Net*> right;
-		  RightNetChainCB cb( right );
-		  stat->callback( cb );
- 
-		  Handle handle(stat);
-		  handle.setRight( right );
-		  sync->handle().push_back( handle );
+		  ccstr << setw(indent+4) << "";
+		  if( (*ii)->type()==Event::POSEDGE )
+		    ccstr << "if( !(p" << n << "&1)&&(n" << n << "&1) )\n";
+		  else
+		    ccstr << "if( (p" << n << "&1)&&!(n" << n << "&1) )\n";
+		  ccstr << setw(indent+6) << "" << _event(*ii) << "();\n";
 		}
-	    }
-	}
+	  }
+      ccstr << setw(indent) << "" << "  }\n";
       
-      printProgress(std::cerr,100.0);
-      return true;
+      if( anything )
+	ccstr << setw(indent) << "" << "_anything();\n";
+      for( ii=sync_.begin();ii!=sync_.end();++ii )
+	if( !(*ii)->isDerived()&&(async.find( (*ii)->net() )==async.end()) )
+	  ccstr << setw(indent) << "" << _event(*ii) << "();\n";
+      
+      ccstr << setw(indent) << "" << "if( out!=NULL )\n";
+      ccstr << setw(indent) << "" << "  {\n";
+      for( i=top_->net().begin();i!=top_->net().end();++i )
+	if( _record(i->second,false) )
+	  ccstr << setw(indent+4) << "" << "out[c]." << i->first << " =n" << ident(i->second) << ";\n";
+      ccstr << setw(indent) << "" << "  }\n";
+      
+      indent-=4;ccstr << setw(indent) << "" << "  }\n";
+      indent-=2;ccstr << setw(indent) << "" << "}\n";
     }
-    ////////////////////////////////////////////////////////////////////////
-    void _relate(const Net* net,
-		 set<const Net*>& actnet,
-		 set<const Statement*>& actstat,
-		 list<Handle>& chain)
+    ////////////////////////////////////
+    // the batch entry steps every instance in turn. the instance form is
+    // flattened into the loop, its branches guarded away, so the compiler
+    // vectorizes the loop across instances.
+    void printBatch(ostream& ccstr,int indent,const string& name)
     {
-      if( actnet.find(net)==actnet.end() )
+      ccstr << setw(indent) << "" << "__attribute__((flatten)) void ";
+      ccstr << findName( top_ ) << "::" << name << "()\n";
+      ccstr << setw(indent) << "" << "{\n";
+      ccstr << setw(indent+2) << "" << "for( unsigned int _i=0;_i<instances;_i++ )\n";
+      ccstr << setw(indent+4) << "" << name << "(_i);\n";
+      ccstr << setw(indent) << "" << "}\n";
+    }
+    ////////////////////////////////////
+    // the data shadow of a flip-flop, written by the clocked statements.
+    void printShadow(ostream& ccstr,int indent,bool comm,const string& name,const Net* net)
+    {
+      if( lane_ )
+	{
+	  if( net->isArray() )
+	    std::cerr << " a memory in bitparallel mode is failure profit. \n";
+
+	  printLaneNet(ccstr,indent,'d',net);
+	  if( !net->isArray() )
+	    printLaneCopy(ccstr,'d','n',net);
+	  if( comm )
+	    ccstr << " // " << name << ":data";
+	  ccstr << endl;
+	}
+      else if( net->isArray() )
+	{
+	  ccstr << setw(indent) << "";
+	  printClass(ccstr,net->width());
+
+	  ccstr << 'd' << ident(net) << ';';
+	  if( comm )
+	    ccstr << " // " << name << ":data";
+	  ccstr << endl;
+
+	  ccstr << setw(indent) << "" << "uint32_t   ";
+	  ccstr << 'a' << ident(net) << ';';
+	  if( comm )
+	    ccstr << " // " << name << ":address";
+	  ccstr << endl;
+
+	  ccstr << setw(indent) << "" << "bool       ";
+	  ccstr << 'u' << ident(net);
+	  ccstr << " =false;";
+	  if( comm )
+	    ccstr << " // " << name << ":update";
+	  ccstr << endl;
+	}
+      else
+	{
+	  // ccstr << setw(indent) << "";
+	  //printClass(ccstr,net->width());
+          {
+	    printTypedNet(ccstr,indent,'d',net);
+	    ccstr << 'd' << ident(net) << " =n" << ident(net) << ';';
+	  }
+
+	  if( comm )
+	    ccstr << " // " << name << ":data";
+	  ccstr << endl;
+
+	  ccstr << setw(indent) << "" << "bool       ";
+
+	  ccstr << 'u' << ident(net);
+	  ccstr << " =false;";
+	  if( comm )
+	    ccstr << " // " << name << ":update";
+	  ccstr << endl;
+	}
+    }
+    // the shadow kept in the class, set up for the pieces of a domain.
+    void printHeld(ostream& ccstr,int indent,const Net* net)
+    {
+      ccstr << setw(indent) << "";
+      if( !net->isArray() )
+	ccstr << 'd' << ident(net) << " =n" << ident(net) << "; ";
+      ccstr << 'u' << ident(net) << " =false;\n";
+    }
+    ////////////////////////////////////
+    // the flip-flop takes its shadow once every statement has read it.
+    void printCommit(ostream& ccstr,int indent,const Net* net)
+    {
+      if( lane_ )
 	{
-	  actnet.insert( net );
-	  
-	  multimap<const Net*,const Statement*>::const_iterator i;
-	  set<const Net*>::const_iterator ii;
-	  i =map_.find( net );
-	  if( i!=map_.end() )
+	  if( !net->isArray() )
 	    {
-	      do
-		{
-		  if( actstat.find( i->second )==actstat.end() )
-		    {
-		      actstat.insert( i->second );
-		      
-		      set<const Net*> left;
-		      set<const Net*> right;
-		      LeftNetChainCB  lcb( left );
-		      RightNetChainCB rcb( right );
-		      i->second->callback( lcb );
-		      i->second->callback( rcb );
-		
-		      Handle handle( i->second );
-		      handle.setRight( right );
-		      handle.setLeft( left );
-		      chain.push_front( handle );
-		      
-		      for( ii=right.begin();ii!=right.end();++ii )
-			_relate(*ii,actnet,actstat,chain);
-		    }
-		  i++;
-		}
-	      while( i!=map_.upper_bound( net ) );
+	      ccstr << setw(indent) << "";
+	      printLaneCopy(ccstr,'n','d',net);
+	      ccstr << endl;
 	    }
 	}
+      else if( net->isArray() )
+	{
+	  ccstr << setw(indent) << "";
+	  ccstr << "if( u" << ident(net) << " )\n";
+	  indent+=2;
+
+	  ccstr << setw(indent) << "";
+	  if( paged().find( net )!=paged().end() )
+	    ccstr << 'n' << ident(net) << ".write(a" << ident(net) << ") =d" << ident(net) << ";\n";
+	  else
+	    ccstr << 'n' << ident(net) << "[a" << ident(net) << "] =d" << ident(net) << ";\n";
+	  indent-=2;
+	}
+      else
+	{
+	  ccstr << setw(indent) << "";
+	  ccstr << 'n' << ident(net) << " =d" << ident(net) << ";\n";
+	}
     }
     ////////////////////////////////////
-    bool relate(list<Handle>& chain)
+    // the nets the handles of a method read or write, and those written.
+    void promotion(const list<Handle>& handle,set<const Net*>& use,set<const Net*>& left) const
     {
-      set<const Net*> actnet;
-      
-      set<const Statement*> actstat;
+      set<const Net*> right;
       list<Handle>::const_iterator i;
-      set<const Net*>::const_iterator ii;
-      
-      double per =0.0;
-      double step =100.0/chain.size();
-      
-      printProgress(std::cerr,-1);
-      for( i=chain.begin();i!=chain.end();++i )
-	{
-	  printProgress(std::cerr,per);
-	  per +=step;
-	  
-	  for( ii=(*i).right().begin();ii!=(*i).right().end();++ii )
-	    _relate(*ii,actnet,actstat,chain);
-	}
-      printProgress(std::cerr,100.0);
+      for( i=handle.begin();i!=handle.end();++i )
+	_touch(*i,left,right);
+      use.insert( left.begin(),left.end() );
+      use.insert( right.begin(),right.end() );
+    }
+    // a member net a method uses is loaded into a local of its own name at
+    // the entry, so the compiler keeps it in a register across statements;
+    // memories, wide nets and the nets functions read stay members. the
+    // nets left out are dropped from the set.
+    void printPromote(ostream& ccstr,int indent,bool comm,set<const Net*>& use)
+    {
+      set<const Net*> global;
+      map<string,Function*>::const_iterator f;
+      for( f=top_->function().begin();f!=top_->function().end();++f )
+	if( f->second->statement()!=NULL )
+	  {
+	    RightNetChainCB cb( global );
+	    f->second->statement()->callback( cb );
+	  }
       
-      return true;
+      set<const Net*> keep;
+      map<string,Net*>::const_iterator i;
+      for( i=top_->net().begin();i!=top_->net().end();++i )
+	if( (use.find(i->second)!=use.end())&&isMember(i->second)&&
+	    !i->second->isArray()&&(i->second->width()<=64)&&
+	    (global.find(i->second)==global.end()) )
+	  {
+	    keep.insert( i->second );
+	    printTypedNet(ccstr,indent,'n',i->second);
+	    ccstr << 'n' << ident(i->second) << " =this->n" << ident(i->second) << ';';
+	    if( comm )
+	      ccstr << " // " << i->first << ":promoted";
+	    ccstr << endl;
+	  }
+      use.swap( keep );
     }
-    ////////////////////////////////////////////////////////////////////////
-    bool _inclusion(const set<const Net*>& l,const set<const Net*>& r)
+    // the promoted nets written are stored back before the method returns.
+    void printDemote(ostream& ccstr,int indent,const set<const Net*>& use,const set<const Net*>& left)
     {
-      set<const Net*>::const_iterator i;
-      for( i=l.begin();i!=l.end();++i )
-	if( r.find( *i )!=r.end() )
-	  return true;
-      return false; 
+      map<string,Net*>::const_iterator i;
+      for( i=top_->net().begin();i!=top_->net().end();++i )
+	if( (use.find(i->second)!=use.end())&&(left.find(i->second)!=left.end()) )
+	  ccstr << setw(indent) << "" << "this->n" << ident(i->second) << " =n" << ident(i->second) << ";\n";
     }
     ////////////////////////////////////
-    bool inspect(list<Handle>& chain)
+    void printLocal(ostream& ccstr,int indent,bool comm,const string& name,const Net* net)
     {
-      list<Handle>::iterator i;
-      list<Handle>::iterator ii;
+      if( isMember(net) )
+	return;
       
-      double per =0.0;
-      double step =100.0/chain.size();
-      printProgress(std::cerr,-1);
-      for( i=chain.begin();i!=chain.end();++i )
+      if( lane_ )
 	{
-	  printProgress(std::cerr,per);
-	  per +=step;
+	  // parameters are folded into the lane words.
+	  if( net->type()==Net::PARAMETER )
+	    return;
 	  
-	  for( ii=i;ii!=chain.end();++ii )
+	  printLaneNet(ccstr,indent,'n',net);
+	  if( comm )
+	    ccstr << " // " << name << ":private";
+	  ccstr << endl;
+	  return;
+	}
+      
+      uint64_t value;
+      if( newScope().folded(net,value) )
+	return;
+      
+      printNet(ccstr,indent,net);
+
+      if( net->type()==Net::PARAMETER )
+	{
+	  if( net->rightValue()!=NULL )
 	    {
-	      if( i!=ii )
-		if( _inclusion( (*i).right(),(*ii).left() ) )
-		  {
-		    chain.insert( i,(*ii) );
-		    chain.erase( ii );
-		    return true;
-		  }
+	      ccstr << 'n' << ident(net);
+	      ccstr << " =";
+	      Scope scope =newScope();
+	      RightExpression re(scope,false,ccstr,(net->width()>64) ? net->width() : 32);
+	      net->rightValue()->callback( re );
+	      ccstr << ';';
 	    }
 	}
-      printProgress(std::cerr,100.0);
-      
-      return false;
+
+      if( comm )
+	{
+	  if( net->type()==Net::PARAMETER )
+	    ccstr << " // " << name << ":parameter";
+	  else
+	    ccstr << " // " << name << ":private";
+	}
+      ccstr << endl;
     }
     ////////////////////////////////////
-    bool sort(list<Handle>& chain)
+    // a scheduled statement, a gated one or a latch loop group.
+    void splice(ostream& ccstr,Scope& scope,const Handle& handle,bool comm,int indent,bool cone=true)
     {
-      bool swap;
-      set<const Handle*> loop;
-      list<Handle>::iterator i;
-      list<Handle>::iterator ii;
+      const Node& n =node(handle);
       
-      double per =0.0;
-      double step =100.0/chain.size();
+      map<unsigned int,unsigned int>::const_iterator c =cone_.find( handle.index() );
+      if( cone&&(c!=cone_.end()) )
+	{
+	  // a dirty cone runs and wakes the readers of the nets it changed.
+	  set<const Net*> left;
+	  set<const Net*> right;
+	  _touch(handle,left,right);
+	  
+	  ccstr << setw(indent) << "" << "if( cone_[" << c->second << "] )\n";
+	  ccstr << setw(indent) << "" << "  {\n";indent+=4;
+	  ccstr << setw(indent) << "" << "cone_[" << c->second << "] =false;\n";
+	  
+	  set<const Net*>::const_iterator i;
+	  for( i=left.begin();i!=left.end();++i )
+	    if( !(*i)->isArray()&&(reader_.find(*i)!=reader_.end()) )
+	      {
+		printTypedNet(ccstr,indent,'o',*i);
+		ccstr << 'o' << ident(*i) << " =n" << ident(*i) << ';';
+		if( comm )
+		  ccstr << " // " << top_->findName( *i ) << ":old";
+		ccstr << endl;
+	      }
+	  
+	  splice(ccstr,scope,handle,comm,indent,false);
+	  
+	  for( i=left.begin();i!=left.end();++i )
+	    if( reader_.find(*i)!=reader_.end() )
+	      {
+		ccstr << setw(indent) << "";
+		if( (*i)->isArray() )
+		  printWake(ccstr,reader_[*i],c->second);
+		else
+		  {
+		    ccstr << "if( o" << ident(*i) << "!=n" << ident(*i) << " ) {";
+		    printWake(ccstr,reader_[*i],c->second);
+		    ccstr << " }";
+		  }
+		ccstr << endl;
+	      }
+	  indent-=4;ccstr << setw(indent) << "" << "  }\n";
+	  return;
+	}
       
-      printProgress(std::cerr,-1);
-      for( i=chain.begin();i!=chain.end();++i )
+      if( !n.member().empty() )
 	{
-	  printProgress(std::cerr,per);
-	  per +=step;
+	  ccstr << setw(indent) << "" << "{\n";indent+=2;
+	  ccstr << setw(indent) << "" << "unsigned int iteration =0;\n";
+	  ccstr << setw(indent) << "" << "bool         settle;\n";
+	  ccstr << setw(indent) << "" << "do\n";
+	  ccstr << setw(indent) << "" << "  {\n";indent+=4;
 	  
-	  do
+	  set<const Net*>::const_iterator i;
+	  for( i=n.left().begin();i!=n.left().end();++i )
+	    if( !(*i)->isArray() )
+	      {
+		if( lane_ )
+		  {
+		    printLaneNet(ccstr,indent,'l',*i);
+		    printLaneCopy(ccstr,'l','n',*i);
+		  }
+		else
+		  {
+		    printTypedNet(ccstr,indent,'l',*i);
+		    ccstr << 'l' << ident(*i) << " =n" << ident(*i) << ';';
+		  }
+		if( comm )
+		  ccstr << " // " << top_->findName( *i ) << ":loop";
+		ccstr << endl;
+	      }
+	  
+	  vector<Handle>::const_iterator ii;
+	  for( ii=n.member().begin();ii!=n.member().end();++ii )
+	    splice(ccstr,scope,*ii,comm,indent,false);
+	  
+	  ccstr << setw(indent) << "" << "settle =true;\n";
+	  for( i=n.left().begin();i!=n.left().end();++i )
+	    if( !(*i)->isArray() )
+	      {
+		ccstr << setw(indent) << "" << "if( ";
+		if( lane_&&((*i)->width()>1) )
+		  ccstr << "memcmp(l" << ident(*i) << ",n" << ident(*i)
+			<< ",sizeof(l" << ident(*i) << "))!=0";
+		else
+		  ccstr << 'l' << ident(*i) << "!=n" << ident(*i);
+		ccstr << " ) settle =false;\n";
+	      }
+	  if( threads_>0 )
+	    ccstr << setw(indent) << "" << "__sync_fetch_and_add(&iteration_,1);\n";
+	  else
+	    ccstr << setw(indent) << "" << "iteration_ ++;\n";
+	  
+	  indent-=4;ccstr << setw(indent) << "" << "  }\n";
+	  ccstr << setw(indent) << "" << "while( !settle&&(++iteration<"
+		<< n.member().size()+2 << ") );\n";
+	  // a loop left on its pass limit oscillates
+	  if( threads_>0 )
+	    ccstr << setw(indent) << "" << "if( !settle ) __sync_fetch_and_add(&unsettled_,1);\n";
+	  else
+	    ccstr << setw(indent) << "" << "if( !settle ) unsettled_ ++;\n";
+	  indent-=2;ccstr << setw(indent) << "" << "}\n";
+	}
+      else if( n.statement()!=NULL )
+	{
+	  if( comm )
 	    {
-	      for( ii=i;ii!=chain.end();++ii )
+	      ccstr << setw(indent) << "" << '/' << "************************************" << endl;
+	      n.statement()->toVerilog(ccstr,indent+2);
+	      ccstr << setw(indent) << "" << '*' << '/' << endl;
+	    }
+	  
+	  if( lane_ )
+	    {
+	      if( n.gate()!=NULL )
 		{
-		  swap=false;
-		  if( i!=ii )
-		    if( _inclusion( (*i).right(),(*ii).left() ) )
-		      {
-			if( loop.find( &(*ii) )!=loop.end() )
-			  {
-			    std::cerr << "\nlacing error !\n";
-			    (*ii).statement()->toVerilog(cerr,0);
-			    
-			    return false;
-			  }
-			
-			i =chain.insert( i,(*ii) );
-			chain.erase( ii );
-			
-			loop.insert( &(*ii)  );
-			
-			swap=true;
-			break;
-		      }
-		  if( swap )
-		    break;
+		  // the gate is a lane mask of the first depth.
+		  LaneSplice gated(comm,ccstr,flipflop_,indent+2,1);
+		  
+		  ccstr << setw(indent) << "" << "{\n";
+		  ccstr << setw(indent+2) << "" << "uint64_t m1 =";
+		  LaneExpression::truth(ccstr,n.gate());
+		  ccstr << ";\n";
+		  n.statement()->callback( gated );
+		  ccstr << setw(indent) << "" << "}\n";
+		}
+	      else
+		{
+		  LaneSplice cpp(comm,ccstr,flipflop_,indent);
+		  n.statement()->callback( cpp );
 		}
 	    }
-	  while( swap );
-	  loop.clear();
+	  else if( n.gate()!=NULL )
+	    {
+	      RightExpression re(scope,false,ccstr,32);
+	      StatementSplice gated(scope,comm,ccstr,shadow_,indent+2);
+	      
+	      ccstr << setw(indent) << "" << "if( ";
+	      n.gate()->callback( re );
+	      ccstr << " )\n";
+	      n.statement()->callback( gated );
+	    }
+	  else
+	    {
+	      StatementSplice cpp(scope,comm,ccstr,shadow_,indent);
+	      n.statement()->callback( cpp );
+	    }
 	}
-      
-      printProgress(std::cerr,100.0);
-      
-      return true;
     }
     ////////////////////////////////////////////////////////////////////////
     
@@ -1491,7 +5882,15 @@ namespace moe
   public:
     Convert(bool debug=false):
       Verilog(debug),
-      top_(NULL)
+      top_(NULL),
+      lane_(false),
+      batch_(0),
+      threads_(0),
+      shard_(0),
+      sparse_(0),
+      mux_(false),
+      inline_(0),
+      activity_(false)
     {
       anysync_ = new Synchronous(NULL,Event::ANYEDGE);
     }
@@ -1509,6 +5908,129 @@ namespace moe
     const multimap<const Net*,const Statement*>& handle() const { return map_; }
     
     const Module* top() const { return top_; }
+    Metrics& metrics() { return metrics_; }
+    
+    // every bit becomes an uint64_t carrying 64 independent vectors.
+    void setBitParallel(bool lane) { lane_ =lane; }
+    bool bitParallel() const { return lane_; }
+    // every state net becomes an array across the instances, structure
+    // of arrays, and an event method steps all of them in one loop.
+    void setBatch(unsigned int batch) { batch_ =batch; }
+    // the scope a method is printed in, from the options.
+    Scope newScope() const { return Scope(batch_,mux_,inline_); }
+    unsigned int batch() const { return batch_; }
+    // every domain is split into clusters evaluated on a pool of workers.
+    void setThreads(unsigned int threads) { threads_ =threads; }
+    unsigned int threads() const { return threads_; }
+    // a combinational handle is skipped while none of its inputs changed.
+    void setActivity(bool activity) { activity_ =activity; }
+    bool activity() const { return activity_; }
+    // the source is cut into files of whole methods, kilobytes at most.
+    void setShard(unsigned int shard) { shard_ =shard; }
+    unsigned int shard() const { return shard_; }
+    void setInline(unsigned int size) { inline_ =size; }
+    unsigned int inlineSize() const { return inline_; }
+    void setMux(bool mux) { mux_ =mux; }
+    bool mux() const { return mux_; }
+    // a memory larger than this many kilobytes is paged in as written.
+    void setSparse(unsigned int sparse) { sparse_ =sparse; }
+    unsigned int sparse() const { return sparse_; }
+    ////////////////////////////////////////////////////////////////////////
+    unsigned int level(const Net* net) const
+    {
+      map<const Net*,unsigned int>::const_iterator i =netLevel_.find( net );
+      return (i!=netLevel_.end()) ? i->second : 0;
+    }
+    unsigned int level(const Statement* stat) const
+    {
+      map<const Statement*,unsigned int>::const_iterator i =statLevel_.find( stat );
+      if( i!=statLevel_.end() )
+	return i->second;
+      
+      // a clocked statement sits one above what it reads
+      set<const Net*> right;
+      RightNetChainCB cb( right );
+      stat->callback( cb );
+      
+      unsigned int ret =0;
+      set<const Net*>::const_iterator ii;
+      for( ii=right.begin();ii!=right.end();++ii )
+	ret =max( ret,level(*ii) );
+      return ret+1;
+    }
+    ////////////////////////////////////
+    // depth and width of the scheduled cones, per domain.
+    void printLevel(ostream& ostr) const
+    {
+      vector<const Synchronous*> sync( sync_.begin(),sync_.end() );
+      sync.push_back( anysync_ );
+      
+      vector<const Synchronous*>::const_iterator i;
+      for( i=sync.begin();i!=sync.end();++i )
+	{
+	  map<unsigned int,unsigned int> width;
+	  unsigned int depth =0;
+	  const Node*  deepest =NULL;
+	  
+	  list<Handle>::const_iterator ii;
+	  for( ii=(*i)->handle().begin();ii!=(*i)->handle().end();++ii )
+	    {
+	      const Node& n =node(*ii);
+	      if( (n.statement()==NULL)&&n.member().empty() )
+		continue;
+	      
+	      unsigned int l =level(*ii);
+	      width[l] ++;
+	      if( (deepest==NULL)||(l>depth) )
+		{
+		  depth =l;
+		  deepest =&n;
+		}
+	    }
+	  
+	  ostr << "level : ";
+	  if( (*i)->net()==NULL )
+	    ostr << "anything";
+	  else
+	    {
+	      ostr << top_->findName( (*i)->net() );
+	      if( (*i)->type()==Event::POSEDGE )
+		ostr << ".posedge";
+	      else if( (*i)->type()==Event::NEGEDGE )
+		ostr << ".negedge";
+	      else
+		ostr << ".anyedge";
+	    }
+	  ostr << " depth " << depth << '\n';
+	  
+	  unsigned int widest =0;
+	  map<unsigned int,unsigned int>::const_iterator w;
+	  for( w=width.begin();w!=width.end();++w )
+	    widest =max( widest,w->second );
+	  
+	  for( w=width.begin();w!=width.end();++w )
+	    {
+	      ostr << setw(8) << w->first << setw(8) << w->second << ' ';
+	      ostr << string( (widest>60) ? (w->second*60+widest-1)/widest : w->second,'#' ) << '\n';
+	    }
+	  
+	  if( deepest!=NULL )
+	    {
+	      set<const Net*> left =deepest->left();
+	      if( left.empty()&&(deepest->statement()!=NULL) )
+		{
+		  LeftNetChainCB cb( left );
+		  deepest->statement()->callback( cb );
+		}
+	      
+	      ostr << "  critical :";
+	      set<const Net*>::const_iterator l;
+	      for( l=left.begin();l!=left.end();++l )
+		ostr << ' ' << top_->findName( *l );
+	      ostr << '\n';
+	    }
+	}
+    }
     ////////////////////////////////////////////////////////////////////////
     bool setTop(const char* name)
     {
@@ -1518,9 +6040,23 @@ namespace moe
 	{
 	  cerr << "ungroup instance...\n";
 	  
+	  metrics_.begin("ungroup");
 	  top_->ungroup();
 	  
 	  top_->link();
+	  metrics_.end(top_->process().size());
+	  
+	  // the generated names follow the hierarchical names
+	  {
+	    map<string,Net*>::const_iterator i;
+	    for( i=top_->net().begin();i!=top_->net().end();++i )
+	      ident(i->second,i->first);
+	    
+	    map<string,Function*>::const_iterator ii;
+	    for( ii=top_->function().begin();ii!=top_->function().end();++ii )
+	      for( i=ii->second->net().begin();i!=ii->second->net().end();++i )
+		ident(i->second,ii->first+'.'+i->first);
+	  }
 
 	  {
 	    vector<Process*>::const_iterator i;
@@ -1539,6 +6075,16 @@ namespace moe
 		  {
 		    if( (*i)->isStorage()&&(*i)->isLevel() )
 		      latch_.insert( (*i)->leftChain().begin(),(*i)->leftChain().end() );
+		    else if( ((*i)->type()==Process::ALWAYS)&&(*i)->isLevel()&&
+			     (typeid( *(*i)->statement() )==typeid( EventStatement )) )
+		      {
+			// a level sensitive block which keeps a value on some path
+			const Statement* stat =((EventStatement*)(*i)->statement())->statement();
+			set<const Net*>::const_iterator ii;
+			for( ii=(*i)->leftChain().begin();ii!=(*i)->leftChain().end();++ii )
+			  if( !_complete(stat,*ii) )
+			    latch_.insert( *ii );
+		      }
 		    
 		    switch( (*i)->type() )
 		      {
@@ -1602,57 +6148,163 @@ namespace moe
 	      }
 	  }
 
+	  levelize();
+	  
  	  return true;
 	}
       else
 	return false;
     }
     ////////////////////////////////////////////////////////////////////////
+    bool addSynchronous(const Net* net,int type,bool derived)
+    {
+      bool ret;
+      const char* name =top_->findName(net);
+      
+      if( !derived )
+	syncsrc_.insert(net);
+      
+      if( derived )
+	std::cerr << "derived source : ";
+      else
+	std::cerr << "synchronous source : ";
+      
+      std::cerr << name;
+      if( type==Event::POSEDGE )
+	std::cerr << ".posedge";
+      else if( type==Event::NEGEDGE )
+	std::cerr << ".negedge";
+      else
+	std::cerr << ".anyedge";	    
+      std::cerr << endl;
+      
+      Synchronous* sync =new Synchronous(net,type,derived);
+      sync_.push_back( sync );
+      
+      std::cerr << "trace... ";
+      metrics_.begin("trace");
+      trace(net,type,sync);
+      metrics_.end(sync->handle().size());
+      std::cerr << '\n';
+      
+      std::cerr << "relate... ";
+      metrics_.begin("relate");
+      ret =relate(sync->handle());
+      metrics_.end(sync->handle().size());
+      std::cerr << '\n';
+      
+      if( group(sync->handle())>0 )
+	std::cerr << "latch loop grouped.\n";
+      
+      std::cerr << "sort... ";
+      metrics_.begin("sort");
+      sort(sync->handle());
+      metrics_.end(sync->handle().size());
+      std::cerr << '\n';
+      
+      std::cerr << "inspect... ";
+      metrics_.begin("inspect");
+      inspect(sync->handle());
+      metrics_.end(sync->handle().size());
+      std::cerr << '\n';
+      
+      return ret;
+    }
     bool setSynchronous(const char* name,int type)
     {
       if( top_!=NULL )
 	{
-	  bool ret;
-	  const Net* net =top_->findNet(name);
-	  
-	  if( net!=NULL )
+	  const Net* net =top_->findNet(name);
+	  
+	  if( net!=NULL )
+	    return addSynchronous(net,type,false);
+	}
+      return false;
+    }
+    ////////////////////////////////////////////////////////////////////////
+    // collect the clock domains from the event controls of the edge
+    // sensitive processes.
+    bool inferSynchronous()
+    {
+      if( top_==NULL )
+	return false;
+      
+      std::cerr << "infer synchronous source...\n";
+      
+      vector< pair<const Net*,int> > edge;
+      set<const Net*>                clock;
+      {
+	vector<Process*>::const_iterator i;
+	for( i=top_->process().begin();i!=top_->process().end();++i )
+	  {
+	    if( ((*i)->type()==Process::ALWAYS)&&
+		(typeid( *((*i)->statement()) )==typeid( EventStatement ))&&
+		(*i)->isEdge() )
+	      {
+		const EventStatement* es =(const EventStatement*)(*i)->statement();
+		vector<Event*>::const_iterator ii;
+		for( ii=es->event().begin();ii!=es->event().end();++ii )
+		  {
+		    if( _plain((*ii)->expression()) )
+		      {
+			const Net* net =(*ii)->expression()->net();
+			edge.push_back( pair<const Net*,int>(net,(*ii)->type()) );
+			clock.insert( net );
+		      }
+		    else
+		      {
+			std::cerr << "a event expression ";
+			(*ii)->toVerilog( std::cerr );
+			std::cerr << " is failure profit. \n";
+		      }
+		  }
+	      }
+	  }
+      }
+      
+      // primary sources first, then the derived ones in order of appearance.
+      vector< pair<const Net*,int> > root;
+      {
+	vector< pair<const Net*,int> >::const_iterator i;
+	for( i=edge.begin();i!=edge.end();++i )
+	  {
+	    int type =i->second;
+	    const Net* net =_source(i->first,type,clock);
+	    pair<const Net*,int> src(net,type);
+	    if( find( root.begin(),root.end(),src )==root.end() )
+	      root.push_back( src );
+	  }
+	
+	// a clock read as a level also needs its other edge to be stepped.
+	unsigned int n =root.size();
+	unsigned int ii;
+	for( ii=0;ii<n;ii++ )
+	  if( _level(root[ii].first) )
+	    {
+	      pair<const Net*,int> src(root[ii].first,
+				       (root[ii].second==Event::POSEDGE) ? Event::NEGEDGE : Event::POSEDGE);
+	      if( find( root.begin(),root.end(),src )==root.end() )
+		root.push_back( src );
+	    }
+      }
+      
+      bool ret =true;
+      int pass;
+      for( pass=0;pass<2;pass++ )
+	{
+	  vector< pair<const Net*,int> >::const_iterator i;
+	  for( i=root.begin();i!=root.end();++i )
 	    {
-	      syncsrc_.insert(net);
-	      
-	      std::cerr << "synchronous source : ";
-	      
-	      std::cerr << name;
-	      if( type==Event::POSEDGE )
-		std::cerr << ".posedge";
-	      else if( type==Event::NEGEDGE )
-		std::cerr << ".negedge";
-	      else
-		std::cerr << ".anyedge";	    
-	      std::cerr << endl;
-	      
-	      Synchronous* sync =new Synchronous(net,type);
-	      sync_.push_back( sync );
-
-	      std::cerr << "trace... ";
-	      trace(net,type,sync);
-	      std::cerr << '\n';
-	      
-	      std::cerr << "relate... ";
-	      ret =relate(sync->handle());
-	      std::cerr << '\n';
+	      bool derived =(flipflop_.find(i->first)!=flipflop_.end())||
+		(latch_.find(i->first)!=latch_.end());
 	      
-	      std::cerr << "sort... ";
-	      sort(sync->handle());
-	      std::cerr << '\n';
-	      
-	      std::cerr << "inspect... ";
-	      inspect(sync->handle());
-	      std::cerr << '\n';
-
-	      return ret;
+	      if( derived==(pass==1) )
+		if( !addSynchronous(i->first,i->second,derived) )
+		  ret =false;
 	    }
 	}
-      return false;
+      
+      return ret;
     }
     bool setAnything()
     {
@@ -1670,25 +6322,32 @@ namespace moe
 		     (i->second->interface()==Net::INOUT))&&
 		    (flipflop_.find(i->second)==flipflop_.end()) )
 		  {
-		    set<const Net*> right;
-		    right.insert( i->second );
-		    Handle handle(NULL);
-		    handle.setRight( right );
+		    Handle handle =newNode(NULL);
+		    node_[handle.index()].right().insert( i->second );
 		    anysync_->handle().push_back( handle );
 		  }
 	      }
 	  }
 	  
 	  std::cerr << "relate... ";
+	  metrics_.begin("relate");
 	  ret =relate(anysync_->handle());
+	  metrics_.end(anysync_->handle().size());
 	  std::cerr << '\n';
 	  
+	  if( group(anysync_->handle())>0 )
+	    std::cerr << "latch loop grouped.\n";
+	  
 	  std::cerr << "sort... ";
+	  metrics_.begin("sort");
 	  sort(anysync_->handle());
+	  metrics_.end(anysync_->handle().size());
 	  std::cerr << '\n';
 	  
 	  std::cerr << "inspect... ";
+	  metrics_.begin("inspect");
 	  inspect(anysync_->handle());
+	  metrics_.end(anysync_->handle().size());
 	  std::cerr << '\n';
 	  
 	  return ret;
@@ -1702,6 +6361,40 @@ namespace moe
       string fname;
       int indent;
       set<const Net*> vcdNet;
+      bool loop     =grouped();
+      bool anything =sync_.empty()||!latch_.empty();
+      
+      shadow_ =flipflop_;
+      if( vcd&&lane_ )
+	{
+	  std::cerr << " a dumpvars in bitparallel mode is failure profit. \n";
+	  vcd =false;
+	}
+      if( vcd&&(batch_>0) )
+	{
+	  std::cerr << " a dumpvars in batch mode is failure profit. \n";
+	  vcd =false;
+	}
+      if( (threads_>0)&&(batch_>0) )
+	{
+	  std::cerr << " a threads in batch mode is failure profit. \n";
+	  threads_ =0;
+	}
+      if( vcd&&(threads_>0) )
+	{
+	  std::cerr << " a dumpvars in threads mode is failure profit. \n";
+	  vcd =false;
+	}
+      if( activity_&&(lane_||(batch_>0)||(threads_>0)) )
+	{
+	  std::cerr << " a activity with bitparallel, batch or threads is failure profit. \n";
+	  activity_ =false;
+	}
+      if( activity_ )
+	cones();
+      
+      metrics_.begin("emit");
+      slices(comm,vcd);
       
       ////////////////////////////////////////////////////////////////////////
       ////////////////////////////////////////////////////////////////////////
@@ -1718,6 +6411,10 @@ namespace moe
 
       //hhstr << setw(indent) << "" << "#include \"EmVer.hh\"" << endl;
       hhstr << setw(indent) << "" << "#include \"stdint.h\"" << endl;
+      if( lane_ )
+	hhstr << setw(indent) << "" << "#include \"string.h\"" << endl;
+      if( !lane_||(threads_>0) )
+	hhstr << setw(indent) << "" << "#include \"EmVer.hh\"" << endl;
       
       hhstr << setw(indent) << "" << "namespace moe" << endl;
       hhstr << setw(indent) << "" << '{' << endl;
@@ -1737,6 +6434,104 @@ namespace moe
 	  hhstr << setw(indent) << "" << "////////////////////////////////////////////////////////////////////////\n";
 	}
       
+      ////////////////////////////////////
+      // latch loop
+      if( loop )
+	{
+	  hhstr << setw(indent) << "" << "uint64_t   iteration_;\n";
+	  hhstr << setw(indent) << "" << "uint64_t   unsettled_;\n";
+	}
+      
+      ////////////////////////////////////
+      // dirty cones and the last seen level of their sensed nets
+      if( !cone_.empty() )
+	{
+	  hhstr << setw(indent) << "" << "bool       cone_[" << cone_.size() << "];\n";
+	  
+	  map<string,Net*>::const_iterator i;
+	  for( i=top_->net().begin();i!=top_->net().end();++i )
+	    if( (sense_.find(i->second)!=sense_.end())&&!i->second->isArray() )
+	      {
+		printTypedNet(hhstr,indent,'s',i->second);
+		if( comm )
+		  hhstr << " // " << i->first << ":seen";
+		hhstr << endl;
+	      }
+	}
+      
+      ////////////////////////////////////
+      // worker pool and the parts of every domain
+      if( threads_>0 )
+	{
+	  vector<string> name;
+	  {
+	    vector<Synchronous*>::const_iterator i;
+	    for( i=sync_.begin();i!=sync_.end();++i )
+	      name.push_back( _event(*i) );
+	    if( anything )
+	      name.push_back( "_anything" );
+	  }
+	  
+	  hhstr << setw(indent) << "" << "Pool       pool_;\n";
+	  vector<string>::const_iterator i;
+	  for( i=name.begin();i!=name.end();++i )
+	    {
+	      unsigned int k;
+	      for( k=0;k<threads_;k++ )
+		hhstr << setw(indent) << "" << "void " << (*i) << '_' << k << "();\n";
+	      hhstr << setw(indent) << "" << "static void " << (*i) << "_job(void* self,uint32_t part);\n";
+	    }
+	}
+      
+      ////////////////////////////////////
+      // the pieces of the methods over the shard size, and the shadows
+      // the clocked pieces write
+      if( !piece_.empty() )
+	{
+	  map<string,vector<vector<Handle> > >::const_iterator i;
+	  for( i=piece_.begin();i!=piece_.end();++i )
+	    {
+	      unsigned int k;
+	      for( k=0;k<i->second.size();k++ )
+		hhstr << setw(indent) << "" << "void " << i->first << '_' << k << "();\n";
+	    }
+	  
+	  set<const Net*> written;
+	  vector<Synchronous*>::const_iterator ii;
+	  for( ii=sync_.begin();ii!=sync_.end();++ii )
+	    if( _sliced(_event(*ii)) )
+	      _written(*ii,written);
+	  set<const Net*>::const_iterator iii;
+	  for( iii=written.begin();iii!=written.end();++iii )
+	    {
+	      string name =top_->findName( *iii );
+	      if( (*iii)->isArray() )
+		{
+		  hhstr << setw(indent) << "";
+		  printClass(hhstr,(*iii)->width());
+		  hhstr << 'd' << ident(*iii) << ';';
+		  if( comm )
+		    hhstr << " // " << name << ":data";
+		  hhstr << endl;
+		  hhstr << setw(indent) << "" << "uint32_t   a" << ident(*iii) << ';';
+		  if( comm )
+		    hhstr << " // " << name << ":address";
+		  hhstr << endl;
+		}
+	      else
+		{
+		  printTypedNet(hhstr,indent,'d',*iii);
+		  if( comm )
+		    hhstr << " // " << name << ":data";
+		  hhstr << endl;
+		}
+	      hhstr << setw(indent) << "" << "bool       u" << ident(*iii) << ';';
+	      if( comm )
+		hhstr << " // " << name << ":update";
+	      hhstr << endl;
+	    }
+	}
+      
 
 
       /***
@@ -1764,16 +6559,24 @@ namespace moe
       if( debug() )
 	std::cerr << "generate registers\n";
       {
-	map<string,Net*>::const_iterator i;
-	for( i=top_->net().begin();i!=top_->net().end();++i )
+	vector<pair<string,Net*> > member;
+	layout(member);
+	
+	vector<pair<string,Net*> >::const_iterator i;
+	for( i=member.begin();i!=member.end();++i )
 	  {
-	    if( syncsrc_.find( i->second )==syncsrc_.end() )
+	    if( (syncsrc_.find( i->second )==syncsrc_.end())||_level(i->second) )
 	      {
 		if( (i->second->interface()!=Net::PRIVATE)||
 		    (flipflop_.find(i->second)!=flipflop_.end())||
-		    (latch_.find(i->second)!=latch_.end()) )	       
+		    (latch_.find(i->second)!=latch_.end())||
+		    (spill_.find(i->second)!=spill_.end())||
+		    (activity_&&(i->second->type()!=Net::PARAMETER)) )
 		  {
-		    printNet(hhstr,indent,i->second);
+		    if( lane_ )
+		      printLaneNet(hhstr,indent,'n',i->second,batch_);
+		    else
+		      printNet(hhstr,indent,i->second,batch_);
 
 		    /**
 		    printClass(hhstr,i->second->width(),indent);
@@ -1821,6 +6624,19 @@ namespace moe
 	      }
 	  }
       }
+      // the level of an asynchronous source, the clocks test it
+      {
+	vector<const Net*> kept;
+	_kept(kept);
+	vector<const Net*>::const_iterator i;
+	for( i=kept.begin();i!=kept.end();++i )
+	  {
+	    printTypedNet(hhstr,indent,'n',*i);
+	    if( comm )
+	      hhstr << " // " << top_->findName( *i ) << ":level";
+	    hhstr << endl;
+	  }
+      }
 
 
       ////////////////////////////////////
@@ -1830,8 +6646,11 @@ namespace moe
       {
 	hhstr << setw(indent) << "" << "////////////////////////////////////////////////////////////////////////\n";
 
+	if( lane_&&!top_->function().empty() )
+	  std::cerr << " a function in bitparallel mode is failure profit. \n";
+	
 	map<string,Function*>::const_iterator i;
-	for( i=top_->function().begin();i!=top_->function().end();++i )
+	for( i=top_->function().begin();(i!=top_->function().end())&&!lane_;++i )
 	  {
 	    Function* func =i->second;
 	    vector<string>::const_iterator ii;
@@ -1844,7 +6663,7 @@ namespace moe
 		    hhstr << setw(indent) << "";
 		    printClass(hhstr,net->width());
 		    //		    hhstr.form("f%08X",net);
-		    hhstr << 'f' << (uintptr_t)net;
+		    hhstr << 'f' << ident(net);
 		    
 		    hhstr << '(';
 		  }
@@ -1860,11 +6679,13 @@ namespace moe
 		    printRef(hhstr,net->width());
 		    hhstr << ' ';
 		    //		    hhstr.form("n%08X",net);
-		    hhstr << 'n' << (uintptr_t)net;
+		    hhstr << 'n' << ident(net);
 		    
 		    second=true;
 		  }
 	      }
+	    if( batch_>0 )
+	      hhstr << (second ? ",unsigned int _i" : "unsigned int _i");
 	    hhstr << ");" << endl;
 	  }
       }
@@ -1872,18 +6693,59 @@ namespace moe
 
       ////////////////////////////////////
       hhstr << setw(indent-2) << "" << "public:" << endl;
+      if( batch_>0 )
+	hhstr << setw(indent) << "" << "static const unsigned int instances =" << batch_ << ";\n";
       hhstr << setw(indent) << "" << findName( top_ ) << "()";
-      if( vcd )
+      {
+	vector<string> init;
+	if( vcd )
+	  {
+	    init.push_back( "vcd_(NULL)" );
+	    init.push_back( "time_(0)" );
+	  }
+	if( loop )
+	  {
+	    init.push_back( "iteration_(0)" );
+	    init.push_back( "unsettled_(0)" );
+	  }
+	if( threads_>0 )
+	  {
+	    std::ostringstream pool;
+	    pool << "pool_(" << threads_ << ')';
+	    init.push_back( pool.str() );
+	  }
+	// no set or reset is active until run gives its level
+	vector<const Net*> kept;
+	_kept(kept);
+	vector<const Net*>::const_iterator ii;
+	for( ii=kept.begin();ii!=kept.end();++ii )
+	  {
+	    std::ostringstream level;
+	    level << 'n' << ident(*ii) << "(0)";
+	    init.push_back( level.str() );
+	  }
+	
+	if( !init.empty() )
+	  {
+	    hhstr << ":\n";
+	    vector<string>::const_iterator i;
+	    for( i=init.begin();i!=init.end();++i )
+	      hhstr << setw(indent+2) << "" << (*i) << ((i+1!=init.end()) ? ",\n" : "\n");
+	  }
+	else
+	  {
+	    hhstr << "\n";
+	  }
+      }
+      if( !cone_.empty() )
 	{
-	  hhstr << ":\n";
-	  hhstr << setw(indent+2) << "" << "vcd_(NULL),\n";
-	  hhstr << setw(indent+2) << "" << "time_(0)\n";
+	  hhstr << setw(indent) << "" << "{\n";
+	  hhstr << setw(indent+2) << "" << "for( unsigned int i=0;i<" << cone_.size() << ";i++ )\n";
+	  hhstr << setw(indent+4) << "" << "cone_[i] =true;\n";
+	  hhstr << setw(indent) << "" << "}\n";
 	}
       else
-	{
-	  hhstr << "\n";
-	}
-      hhstr << setw(indent) << "" << "{}" << endl;
+	hhstr << setw(indent) << "" << "{}" << endl;
       hhstr << setw(indent) << "" << '~' << findName( top_ ) << "(){}" << endl;
 
 
@@ -1895,6 +6757,15 @@ namespace moe
 	  hhstr << setw(indent) << "" << "void vcd_open(const char* fname);\n";
 	  hhstr << setw(indent) << "" << "void vcd_close();\n";
 	}
+      
+      ////////////////////////////////////
+      // latch loop
+      if( loop )
+	{
+	  hhstr << setw(indent) << "" << "////////////////////////////////////////////////////////////////////////\n";
+	  hhstr << setw(indent) << "" << "uint64_t iteration() const { return iteration_; }\n";
+	  hhstr << setw(indent) << "" << "uint64_t unsettled() const { return unsettled_; }\n";
+	}
 
       ////////////////////////////////////
       // port
@@ -1902,13 +6773,21 @@ namespace moe
 	std::cerr << "generete ports\n";
       {
 	hhstr << setw(indent) << "" << "////////////////////////////////////////////////////////////////////////\n";
+	vector<const Net*> kept;
+	_kept(kept);
 	map<string,Net*>::const_iterator i;
 	for( i=top_->net().begin();i!=top_->net().end();++i )
 	  {
-	    if( syncsrc_.find( i->second )==syncsrc_.end() )
+	    // the level of an asynchronous set or reset is a port as well,
+	    // to hold it while the clocks step
+	    if( (syncsrc_.find( i->second )==syncsrc_.end())||
+		(find( kept.begin(),kept.end(),i->second )!=kept.end()) )
 	      if( (i->second->interface()!=Net::PRIVATE) )
 		{
-		  printPort(hhstr,indent,i->second,i->first);
+		  if( lane_ )
+		    printLanePort(hhstr,indent,i->second,i->first,batch_>0);
+		  else
+		    printPort(hhstr,indent,i->second,i->first,batch_>0);
 		  /*
 		  printPort(hhstr,i->second->width(),indent);
 		  hhstr << i->first << "() { return ";
@@ -1945,6 +6824,33 @@ namespace moe
 	      hhstr << "_anyedge";	    
 	    
 	    hhstr << "();" << endl;
+	    
+	    if( batch_>0 )
+	      {
+		hhstr << setw(indent) << "" << "void ";
+		hhstr << top_->findName( (*i)->net() );
+		if( (*i)->type()==Event::POSEDGE )
+		  hhstr << "_posedge";
+		else if( (*i)->type()==Event::NEGEDGE )
+		  hhstr << "_negedge";
+		else
+		  hhstr << "_anyedge";
+		hhstr << "(unsigned int _i);" << endl;
+	      }
+	  }
+	
+	if( anything )
+	  {
+	    hhstr << setw(indent) << "" << "////////////////////////////////////////////////////////////////////////\n";
+	    hhstr << setw(indent) << "" << "void _anything();" << endl;
+	    if( batch_>0 )
+	      hhstr << setw(indent) << "" << "void _anything(unsigned int _i);" << endl;
+	  }
+	
+	if( !lane_&&(batch_==0) )
+	  {
+	    hhstr << setw(indent) << "" << "////////////////////////////////////////////////////////////////////////\n";
+	    printRecord(hhstr,indent);
 	  }
       }
       
@@ -1958,8 +6864,7 @@ namespace moe
       ////////////////////////////////////////////////////////////////////////
       ////////////////////////////////////////////////////////////////////////
       
-      fname =string(path) + findName( top_ ) + ".cc";
-      std::ofstream ccstr(fname.c_str());
+      std::ostringstream ccstr;
       indent=0;
       
 
@@ -1980,11 +6885,13 @@ namespace moe
       if( debug() )
 	std::cerr << "generate functions\n";
       {
-	ccstr << setw(indent) << "" << "////////////////////////////////////////////////////////////////////////\n";
+	printCut(ccstr,indent);
 	
         map<string,Function*>::const_iterator i;
-        for( i=top_->function().begin();i!=top_->function().end();++i )
+	for( i=top_->function().begin();(i!=top_->function().end())&&!lane_;++i )
           {
+	    if( i!=top_->function().begin() )
+	      cut_.push_back( ccstr.tellp() );
 	    Function* func =i->second;
 	    vector<string>::const_iterator ii;
 	    bool second=false;
@@ -1997,7 +6904,7 @@ namespace moe
 		    printClass(ccstr,net->width());
 		    ccstr << findName( top_ ) << "::";
 		    //		    ccstr.form("f%08X",net);
-		    ccstr << 'f' << (uintptr_t)net;
+		    ccstr << 'f' << ident(net);
 		    ccstr << '(';
 		  }
 	      }
@@ -2014,32 +6921,24 @@ namespace moe
 		    ccstr << ' ';
 		    
 		    //		    ccstr.form("n%08X",net);
-		    ccstr << 'n' << (uintptr_t)net;
+		    ccstr << 'n' << ident(net);
 		    
 		    second=true;
 		  }
 	      }
+	    if( batch_>0 )
+	      ccstr << (second ? ",unsigned int _i" : "unsigned int _i");
 	    ccstr << ')' << endl;
 	    ccstr << setw(indent) << "" << '{' << endl;indent+=2;
+	    if( batch_>0 )
+	      printInstance(ccstr,indent);
 	    
-	    for( ii=func->port().begin();ii!=func->port().end();++ii )
-	      {
-		Net* net =func->net().find(*ii)->second;
-		
-		if( net->interface()==Net::PRIVATE )
-		  if( net->type()==Net::REG )
-		      {
-			ccstr << setw(indent) << "";
-			printRef(ccstr,net->width());
-			ccstr << ' ';
-			//		    ccstr.form("n%08X",net);
-			ccstr << 'n' << (uintptr_t)net;
-			ccstr << ";\n";
-		      }
-	      }
+	    // the result is a local, returned once the body has run
+	    printLocals(ccstr,indent,func);
 
 	    {
-	      StatementSplice cpp(comm,ccstr,flipflop_,indent);
+	      Scope scope =newScope();
+	      StatementSplice cpp(scope,comm,ccstr,flipflop_,indent);
 	      {
 		if( comm )
 		  {
@@ -2050,6 +6949,12 @@ namespace moe
 		i->second->statement()->callback( cpp );
 	      }
 	    }
+	    for( ii=func->port().begin();ii!=func->port().end();++ii )
+	      if( func->net().find(*ii)->second->type()==Net::FUNCTION )
+		{
+		  ccstr << setw(indent) << "" << "return n" << ident(func->net().find(*ii)->second) << ";\n";
+		  break;
+		}
 
 	    indent-=2;ccstr << setw(indent) << "" << '}' << endl;
 
@@ -2058,35 +6963,65 @@ namespace moe
       }
 
 
-      /***
       ////////////////////////////////////
-      // do anything signals
+      // do anything signals : the level sensitive entry, for a design
+      // without clock or with latches.
+      if( _sliced("_level") )
+	{
+	  printCut(ccstr,indent);
+	  printPieces(ccstr,indent,comm,"_level");
+	}
+      if( anything )
       {
-	ccstr << setw(indent) << "" << "////////////////////////////////////////////////////////////////////////\n";
+	if( !_sliced("_level") )
+	  printCut(ccstr,indent);
+	if( threads_>0 )
+	  printParts(ccstr,indent,comm,"_anything",NULL);
 
 	ccstr << setw(indent) << "" << "void ";
-	ccstr << findName( top_ ) << "::" << "_anything()\n";
+	ccstr << findName( top_ ) << "::" << ((batch_>0) ? "_anything(unsigned int _i)\n" : "_anything()\n");
 
 	ccstr << setw(indent) << "" << '{' << endl;indent+=2;
-	{
-	  StatementSplice cpp(comm,ccstr,flipflop_,indent);
-	  list<Handle>::const_iterator ii;
-	  for( ii=anysync_->handle().begin();ii!=anysync_->handle().end();++ii )
-	    if( (*ii).statement()!=NULL )
+	if( batch_>0 )
+	  printInstance(ccstr,indent);
+	if( threads_>0 )
+	  ccstr << setw(indent) << "" << "pool_.run(_anything_job,this);\n";
+	else
+	  {
+	    Scope scope =newScope();
+	    set<const Net*> promoted;
+	    set<const Net*> written;
+	    if( !lane_&&(batch_==0)&&!_sliced("_level") )
 	      {
-		if( comm )
-		  {
-		    ccstr << setw(indent) << "" << '/' << "************************************" << endl;
-		    (*ii).statement()->toVerilog(ccstr,indent+2);
-		    ccstr << setw(indent) << "" << '*' << '/' << endl;
-		  }
-		
-		(*ii).statement()->callback( cpp );
+		promotion(anysync_->handle(),promoted,written);
+		printPromote(ccstr,indent,comm,promoted);
 	      }
-	}
+	    if( !_sliced("_level") )
+	    {
+	      map<string,Net*>::const_iterator i;
+	      for( i=top_->net().begin();i!=top_->net().end();++i )
+		if( (i->second->interface()==Net::PRIVATE)&&
+		    (flipflop_.find(i->second)==flipflop_.end())&&
+		    (latch_.find(i->second)==latch_.end()) )
+		  printLocal(ccstr,indent,comm,i->first,i->second);
+	    }
+	    if( activity_ )
+	      printSense(ccstr,indent);
+	    if( _sliced("_level") )
+	      printPieceCalls(ccstr,indent,"_level");
+	    else
+	    {
+	      list<Handle>::const_iterator ii;
+	      for( ii=anysync_->handle().begin();ii!=anysync_->handle().end();++ii )
+		splice(ccstr,scope,*ii,comm,indent);
+	    }
+	    printDemote(ccstr,indent,promoted,written);
+	  }
 	indent-=2;ccstr << setw(indent) << "" << '}' << endl;
+	
+	if( batch_>0 )
+	  printBatch(ccstr,indent,"_anything");
       }
-      ***/
 
 
       ////////////////////////////////////
@@ -2098,8 +7033,13 @@ namespace moe
 	for( i=sync_.begin();i!=sync_.end();++i )
 	  {
 	    vector<Synchronous*>::const_iterator sync =i;
+	    shadow_ =flipflop_;
 	    
-	    ccstr << setw(indent) << "" << "////////////////////////////////////////////////////////////////////////\n";
+	    printCut(ccstr,indent);
+	    if( threads_>0 )
+	      printParts(ccstr,indent,comm,_event(*i),*i);
+	    else if( _sliced(_event(*i)) )
+	      printPieces(ccstr,indent,comm,_event(*i));
 
 	    ccstr << setw(indent) << "" << "void ";
 	    ccstr << findName( top_ ) << "::";
@@ -2112,165 +7052,146 @@ namespace moe
 	    else
 	      ccstr << "_anyedge";	    
 
-	    ccstr << "()" << endl;
+	    ccstr << ((batch_>0) ? "(unsigned int _i)" : "()") << endl;
 
 	    ////////////////////////////////////
 	    ccstr << setw(indent) << "" << '{' << endl;indent+=2;
+	    if( batch_>0 )
+	      printInstance(ccstr,indent);
+	    // a domain cut into pieces keeps its shadows in the class
+	    Scope scope =newScope();
+	    bool sliced =_sliced(_event(*i));
+	    if( !lane_&&(threads_==0) )
+	      {
+		shadow_.clear();
+		if( sliced )
+		  _written(*i,shadow_);
+		else
+		  inplace(*i,shadow_);
+	      }
+	    
+	    set<const Net*> promoted;
+	    set<const Net*> written;
+	    if( !lane_&&(batch_==0)&&(threads_==0)&&!sliced&&!_sliced("_level") )
+	      {
+		promotion((*i)->handle(),promoted,written);
+		promotion(anysync_->handle(),promoted,written);
+		vector<Synchronous*>::const_iterator ii;
+		for( ii=sync_.begin();ii!=sync_.end();++ii )
+		  promoted.insert( (*ii)->net() );
+		if( !(*i)->isDerived()&&_level((*i)->net()) )
+		  written.insert( (*i)->net() );
+		printPromote(ccstr,indent,comm,promoted);
+	      }
+	    // with pieces, the locals of the handles run here and the dump
+	    set<const Net*> local;
+	    if( sliced||_sliced("_level") )
+	      {
+		vector<vector<Handle> > unit;
+		if( !sliced )
+		  unit.push_back( _units(_event(*i),(*i)->handle()).front() );
+		if( !_sliced("_level") )
+		  unit.push_back( _units("_level",anysync_->handle()).front() );
+		vector<vector<Handle> >::const_iterator ii;
+		for( ii=unit.begin();ii!=unit.end();++ii )
+		  {
+		    vector<Handle>::const_iterator iii;
+		    for( iii=ii->begin();iii!=ii->end();++iii )
+		      _touch(*iii,local,local);
+		  }
+	      }
+	    if( threads_==0 )
 	    {
 	      map<string,Net*>::const_iterator i;
 	      for( i=top_->net().begin();i!=top_->net().end();++i )
 		{
 		  if( flipflop_.find(i->second)==flipflop_.end() )
 		    {
-		      if( (i->second->interface()==Net::PRIVATE) )
+		      if( (i->second->interface()==Net::PRIVATE)&&
+			  (latch_.find(i->second)==latch_.end())&&
+			  (!(sliced||_sliced("_level"))||vcd||(local.find(i->second)!=local.end())) )
 			{
-
-			  printNet(ccstr,indent,i->second);
-			  /*
-			    ccstr << setw(indent) << "";
-			    printClass(ccstr,i->second->width());
-			    //ccstr.form("n%08X;",i->second);
-			    ccstr << 'n' << (uint)i->second;
-			  */
-
-			  if( i->second->type()==Net::PARAMETER )
-			    {
-			      if( i->second->rightValue()!=NULL )
-				{
-				  ccstr << 'n' << (uintptr_t)i->second;
-				  ccstr << " =";
-				  RightExpression re(false,ccstr,32);
-				  i->second->rightValue()->callback( re );
-				  ccstr << ';';
-				}
-			    }
-
-
-			  if( comm )
-			    {
-			      if( i->second->type()==Net::PARAMETER )
-				ccstr << " // " << i->first << ":parameter";
-			      else
-				ccstr << " // " << i->first << ":private";
-			    }
-			  ccstr << endl;
-
-			  vcdNet.insert( i->second );
+			  uint64_t value;
+			  printLocal(ccstr,indent,comm,i->first,i->second);
+			  if( !newScope().folded(i->second,value) )
+			    vcdNet.insert( i->second );
 			}
 		    }
-		  else
+		  else if( shadow_.find(i->second)!=shadow_.end() )
+		    {
+		      if( sliced )
+			printHeld(ccstr,indent,i->second);
+		      else
+			printShadow(ccstr,indent,comm,i->first,i->second);
+		    }
+		}
+	    }
+
+	    ////////////////////////////////////
+	    // a clock read as a level holds the level after its edge
+	    if( !(*i)->isDerived()&&_level((*i)->net()) )
+	      {
+		ccstr << setw(indent) << "" << 'n' << ident((*i)->net());
+		if( lane_ )
+		  ccstr << " =" << (((*i)->type()==Event::POSEDGE) ? "~0ULL" : "0ULL") << ';';
+		else
+		  ccstr << " =" << (((*i)->type()==Event::POSEDGE) ? '1' : '0') << ';';
+		if( comm )
+		  ccstr << " // " << top_->findName( (*i)->net() ) << ":level";
+		ccstr << endl;
+	      }
+
+	    ////////////////////////////////////
+	    // previous level of the derived sources
+	    {
+	      set<const Net*> prev;
+	      vector<Synchronous*>::const_iterator ii;
+	      for( ii=sync_.begin();ii!=sync_.end();++ii )
+		if( (*ii)->isDerived()&&((*ii)->net()!=(*i)->net()) )
+		  if( prev.insert( (*ii)->net() ).second )
 		    {
-		      if( i->second->isArray() )
+		      if( lane_ )
 			{
-			  ccstr << setw(indent) << "";
-			  printClass(ccstr,i->second->width());
-
-			  ccstr << 'd' << (uintptr_t)i->second << ';';
-			  if( comm )
-			    ccstr << " // " << i->first << ":data";
-			  ccstr << endl;
-
-			  ccstr << setw(indent) << "" << "uint32_t   ";
-			  //			  ccstr.form("a%08X;",i->second);
-			  ccstr << 'a' << (uintptr_t)i->second << ';';
-			  if( comm )
-			    ccstr << " // " << i->first << ":address";
-			  ccstr << endl;
-			  
-			  ccstr << setw(indent) << "" << "bool       ";
-			  //			  ccstr.form("u%08X",i->second);
-			  ccstr << 'u' << (uintptr_t)i->second;
-			  ccstr << " =false;";
-			  if( comm )
-			    ccstr << " // " << i->first << ":update";
-			  ccstr << endl;
+			  printLaneNet(ccstr,indent,'p',(*ii)->net());
+			  printLaneCopy(ccstr,'p','n',(*ii)->net());
 			}
 		      else
 			{
-			  // ccstr << setw(indent) << "";
-			  //printClass(ccstr,i->second->width());
-			  {
-			    printTypedNet(ccstr,indent,'d',i->second);
-			    if( i->second->width()<=64 )
-			      ccstr << 'd' << (uintptr_t)i->second << " =n" << (uintptr_t)i->second << ';';
-			    else
-			      ccstr << "memcpy("
-				    << 'd' << (uintptr_t)i->second << ','
-				    << 'n' << (uintptr_t)i->second << ','
-				    << (((i->second->width()+31)/32)*4) << ");";
-			  }
-
-			  if( comm )
-			    ccstr << " // " << i->first << ":data";
-			  ccstr << endl;
-
-			  ccstr << setw(indent) << "" << "bool       ";
-
-			  ccstr << 'u' << (uintptr_t)i->second;
-			  ccstr << " =false;";
-			  if( comm )
-			    ccstr << " // " << i->first << ":update";
-			  ccstr << endl;
+			  printTypedNet(ccstr,indent,'p',(*ii)->net());
+			  ccstr << 'p' << ident((*ii)->net()) << " =n" << ident((*ii)->net()) << ';';
 			}
+		      if( comm )
+			ccstr << " // " << top_->findName( (*ii)->net() ) << ":previous";
+		      ccstr << endl;
 		    }
-		}
 	    }
 
+	    if( activity_ )
+	      printSense(ccstr,indent);
+	    
+	    if( threads_>0 )
+	      ccstr << setw(indent) << "" << "pool_.run(" << _event(*i) << "_job,this);\n";
+	    else if( sliced )
+	      printPieceCalls(ccstr,indent,_event(*i));
+	    else
 	    {
-	      StatementSplice cpp(comm,ccstr,flipflop_,indent);
+	      if( !lane_ )
+		hoist(ccstr,scope,*i,comm,indent);
+	      
 	      list<Handle>::const_iterator ii;
 	      for( ii=(*i)->handle().begin();ii!=(*i)->handle().end();++ii )
-		{
-		  if( (*ii).statement()!=NULL )
-		    {
-		      if( comm )
-			{
-			  ccstr << setw(indent) << "" << '/' << "************************************" << endl;
-			  
-			  (*ii).statement()->toVerilog(ccstr,indent+2);
-			  ccstr << setw(indent) << "" << '*' << '/' << endl;
-			}
-		      (*ii).statement()->callback( cpp );
-		    }
-		}
+		splice(ccstr,scope,*ii,comm,indent);
 	    }
 	    ////////////////////////////////////
 
+	    if( threads_==0 )
 	    {
 	      map<string,Net*>::const_iterator i;
 	      for( i=top_->net().begin();i!=top_->net().end();++i )
 		{
-		  if( flipflop_.find(i->second)!=flipflop_.end() )
+		  if( shadow_.find(i->second)!=shadow_.end() )
 		    {
-		      if( i->second->isArray() )
-			{
-			  ccstr << setw(indent) << "";
-			  //			  ccstr.form("if( u%08X )\n",i->second);
-			  ccstr << "if( u" << (uintptr_t)i->second << " )\n";
-			  indent+=2;
-		      
-			  ccstr << setw(indent) << "";
-			  if( i->second->width()<=64 )
-			    ccstr << 'n' << (uintptr_t)i->second << "[a" << (uintptr_t)i->second << "] =d" << (uintptr_t)i->second << ";\n";
-			  else
-			    ccstr << "memcpy("
-				  << 'n' << (uintptr_t)i->second << "[a" << (uintptr_t)i->second << ']' <<  ','
-				  << 'd' << (uintptr_t)i->second << ','
-			      
-				  << (((i->second->width()+31)/32)*4) << ");\n";
-			  indent-=2;
-			}
-		      else
-			{
-			  ccstr << setw(indent) << "";
-			  if( i->second->width()<=64 )
-			    ccstr << 'n' << (uintptr_t)i->second << " =d" << (uintptr_t)i->second << ";\n";
-			  else
-			    ccstr << "memcpy("
-				  << 'n' << (uintptr_t)i->second << ','
-				  << 'd' << (uintptr_t)i->second << ','
-				  << (((i->second->width()+31)/32)*4) << ");\n";
-			}
+		      printCommit(ccstr,indent,i->second);
 
 		      ////////////////////////////////////
 		      /**
@@ -2284,21 +7205,16 @@ namespace moe
 	    ////////////////////////////////////
 	    //	    ccstr << setw(indent) << "" << "_anything();\n";
 
+	    if( activity_ )
+	      printSense(ccstr,indent);
+	    
+	    if( _sliced("_level") )
+	      printPieceCalls(ccstr,indent,"_level");
+	    else if( threads_==0 )
 	    {
-	      StatementSplice cpp(comm,ccstr,flipflop_,indent);
 	      list<Handle>::const_iterator ii;
 	      for( ii=anysync_->handle().begin();ii!=anysync_->handle().end();++ii )
-		if( (*ii).statement()!=NULL )
-		  {
-		    if( comm )
-		      {
-			ccstr << setw(indent) << "" << '/' << "************************************" << endl;
-			(*ii).statement()->toVerilog(ccstr,indent+2);
-			ccstr << setw(indent) << "" << '*' << '/' << endl;
-		      }
-		    
-		    (*ii).statement()->callback( cpp );
-		  }
+		splice(ccstr,scope,*ii,comm,indent);
 	    }
 
 	    
@@ -2327,7 +7243,7 @@ namespace moe
 			ccstr << "0";
 		      ccstr << "\",vcd_);";
 		      ccstr << "fputs(\" ";
-		      ccstr << 'n' << (uintptr_t)((*ii));
+		      ccstr << 'n' << ident(*ii);
 		      ccstr << "\\n\",vcd_);\n";
 		    }
 		}
@@ -2355,12 +7271,15 @@ namespace moe
 	      for( i=vcdNet.begin();i!=vcdNet.end();++i )
 		if( !((*i)->isArray()) )
 		  {
-		    ccstr << setw(indent) << "" << "vcd_dump(vcd_,";
-		    ccstr << 'n' << (uintptr_t)(*i);
+		    ccstr << setw(indent) << "" << (((*i)->width()>64) ? "EmVer::vcd_dump(vcd_," : "vcd_dump(vcd_,");
+		    if( narrow().find( *i )!=narrow().end() )
+		      ccstr << "uint32_t(n" << ident(*i) << ')';
+		    else
+		      ccstr << 'n' << ident(*i);
 		    ccstr << ',';
 		    ccstr << (*i)->width() << ");";
 		    ccstr << "fputs(\" ";
-		    ccstr << 'n' << (uintptr_t)(*i);
+		    ccstr << 'n' << ident(*i);
 		    ccstr << "\\n\",vcd_);\n";
 		  }
 
@@ -2381,7 +7300,7 @@ namespace moe
 			ccstr << "0";
 		      ccstr << "\",vcd_);";
 		      ccstr << "fputs(\" ";
-		      ccstr << 'n' << (uintptr_t)((*ii));
+		      ccstr << 'n' << ident(*ii);
 		      ccstr << "\\n\",vcd_);\n";
 		    }
 		}
@@ -2392,19 +7311,69 @@ namespace moe
 	      ccstr << setw(indent) << "" << "time_ +=10;\n";
 	    }
 
+	    printDemote(ccstr,indent,promoted,written);
+	    
+	    ////////////////////////////////////
+	    // edges of the derived sources
+	    {
+	      vector<Synchronous*>::const_iterator ii;
+	      for( ii=sync_.begin();ii!=sync_.end();++ii )
+		if( (*ii)->isDerived()&&((*ii)->net()!=(*i)->net()) )
+		  {
+		    uintptr_t n =ident((*ii)->net());
+		    
+		    // the lanes share one call tree, the first lane decides.
+		    if( lane_ )
+		      std::cerr << " a derived source in bitparallel mode follows the lane 0. \n";
+		    
+		    ccstr << setw(indent) << "";
+		    if( (*ii)->type()==Event::POSEDGE )
+		      ccstr << "if( !(p" << n << "&1)&&(n" << n << "&1) )\n";
+		    else
+		      ccstr << "if( (p" << n << "&1)&&!(n" << n << "&1) )\n";
+		    
+		    ccstr << setw(indent+2) << "" << top_->findName( (*ii)->net() );
+		    if( (*ii)->type()==Event::POSEDGE )
+		      ccstr << "_posedge";
+		    else
+		      ccstr << "_negedge";
+		    ccstr << ((batch_>0) ? "(_i);\n" : "();\n");
+		  }
+	    }
+
 
 
 	    ////////////////////////////////////
 	    indent-=2;ccstr << setw(indent) << "" << '}' << endl;
+	    
+	    if( batch_>0 )
+	      {
+		string name =top_->findName( (*i)->net() );
+		if( (*i)->type()==Event::POSEDGE )
+		  name +="_posedge";
+		else if( (*i)->type()==Event::NEGEDGE )
+		  name +="_negedge";
+		else
+		  name +="_anyedge";
+		printBatch(ccstr,indent,name);
+	      }
 
 	  }
       }
+      
+      ////////////////////////////////////
+      // many cycles a call
+      if( !lane_&&(batch_==0) )
+	{
+	  printCut(ccstr,indent);
+	  printRun(ccstr,indent,anything);
+	}
 
       ////////////////////////////////////
       // vcd support
       if( vcd )
 	{
-	  ccstr << setw(indent) << "" << "////////////////////////////////////////////////////////////////////////\n";
+	  printCut(ccstr,indent);
 	  
 	  
 	  ccstr << setw(indent) << "" << "void ";
@@ -2431,7 +7400,7 @@ namespace moe
 		      ccstr << setw(indent) << "" << "fputs(\"$var reg ";
 		      ccstr << (*i)->width() << ' ';
 
-		      ccstr << 'n' << (uintptr_t)(*i);
+		      ccstr << 'n' << ident(*i);
 		      ccstr << ' ';
 		      cptr =top_->findName( *i );
 		      if( *cptr=='\\' )
@@ -2452,7 +7421,7 @@ namespace moe
 		    ccstr << setw(indent) << "" << "fputs(\"$var reg ";
 		    ccstr << (*i)->width() << ' ';
 		    //		    ccstr.form("n%08X",(*i));
-		    ccstr << 'n' << (uintptr_t)(*i);
+		    ccstr << 'n' << ident(*i);
 		    ccstr << ' ';
 		    cptr =top_->findName( *i );
 		    if( *cptr=='\\' )
@@ -2488,8 +7457,12 @@ namespace moe
 	}
 
       ////////////////////////////////////
+      string::size_type tail =ccstr.tellp();
       indent-=2;ccstr << setw(indent) << "" << '}' << endl;
 
+      printShards(path,ccstr.str(),tail);
+
+      metrics_.end((unsigned long)hhstr.tellp() + (unsigned long)ccstr.tellp());
 
     if( debug() )
       std::cerr << "finish\n";
@@ -2509,12 +7482,23 @@ int main(int argc,char* argv[])
   if( argc==1 )
     {
       //      cout << "Verilog2C++ file-name.(v|v2k) module-name ( (posedge|negedge) port-name )+ comments? dumpvars? debug? \n";
-      std::cerr << "Verilog2C++ file-name.(v|v2k) module-name ( (posedge|negedge) port-name )+ comments? dumpvars?\n";
+      std::cerr << "Verilog2C++ file-name.(v|v2k) module-name ( (posedge|negedge) port-name )* comments? dumpvars? levels? metrics? bitparallel? batch=N? threads=N? activity? shard=KB? inline=N? sparse=KB? mux?\n";
+      std::cerr << "  without any (posedge|negedge) the clock domains are inferred from the event controls.\n";
       exit(1);
     }
   bool comments =false;
   bool dumpvars =false;
   bool debug    =false;
+  bool levels   =false;
+  bool metrics  =false;
+  bool bitparallel =false;
+  unsigned int batch =0;
+  unsigned int threads =0;
+  bool activity =false;
+  unsigned int shard =0;
+  unsigned int inlined =0;
+  unsigned int sparse =0;
+  bool mux =false;
   int i;
   for( i=3;i<argc;i++ )
     {
@@ -2524,29 +7508,77 @@ int main(int argc,char* argv[])
 	dumpvars=true;
       else if( strcmp(argv[i],"debug" )==0 )
 	debug=true;
+      else if( strcmp(argv[i],"levels" )==0 )
+	levels=true;
+      else if( strcmp(argv[i],"metrics" )==0 )
+	metrics=true;
+      else if( strcmp(argv[i],"bitparallel" )==0 )
+	bitparallel=true;
+      else if( strncmp(argv[i],"batch=",6 )==0 )
+	batch=atoi(argv[i]+6);
+      else if( strncmp(argv[i],"threads=",8 )==0 )
+	threads=atoi(argv[i]+8);
+      else if( strcmp(argv[i],"activity" )==0 )
+	activity=true;
+      else if( strncmp(argv[i],"shard=",6 )==0 )
+	shard=atoi(argv[i]+6);
+      else if( strncmp(argv[i],"inline=",7 )==0 )
+	inlined=atoi(argv[i]+7);
+      else if( strncmp(argv[i],"sparse=",7 )==0 )
+	sparse=atoi(argv[i]+7);
+      else if( strcmp(argv[i],"mux" )==0 )
+	mux=true;
     }
 
   moe::Convert conv(debug);
+  conv.setBitParallel(bitparallel);
+  conv.setBatch(batch);
+  conv.setThreads(threads);
+  conv.setActivity(activity);
+  conv.setShard(shard);
+  conv.setInline(inlined);
+  conv.setSparse(sparse);
+  conv.setMux(mux);
+  conv.metrics().setReport(metrics);
   
   cerr << "load...\n";
+  conv.metrics().begin("parse");
   conv.parse( argv[1] );
+  conv.metrics().end(conv.module().size());
 
   cerr << "link module...\n";
+  conv.metrics().begin("link");
   conv.link();
+  conv.metrics().end(conv.module().size());
 
   conv.setTop( argv[2] );
   
+  bool clocks =false;
   for( i=3;i<argc;i+=2 )
     {
       if( strcmp(argv[i],"posedge" )==0 )
-	conv.setSynchronous( argv[i+1],moe::Verilog::Event::POSEDGE);
+	{
+	  conv.setSynchronous( argv[i+1],moe::Verilog::Event::POSEDGE);
+	  clocks=true;
+	}
       else if( strcmp(argv[i],"negedge" )==0 )
-	conv.setSynchronous( argv[i+1],moe::Verilog::Event::NEGEDGE);
+	{
+	  conv.setSynchronous( argv[i+1],moe::Verilog::Event::NEGEDGE);
+	  clocks=true;
+	}
     }
+  if( !clocks )
+    conv.inferSynchronous();
 
   conv.setAnything();
+  
+  if( levels )
+    conv.printLevel(std::cerr);
 
   conv.toEmVer("./",comments,dumpvars);
+  
+  if( metrics )
+    conv.metrics().print(std::cerr);
 }
 
 
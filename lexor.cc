@@ -245,6 +245,7 @@ namespace moe
 
       bool isPartial() const;
 
+      bool isConstant() const;
       signed calcConstant() const
       {
 	if( net_!=NULL )
@@ -455,7 +456,17 @@ namespace moe
       const Expression* falseValue() const { return false_; }
       
       unsigned int width() const { return (false_!=NULL) ? max( true_->width(),false_->width() ) : true_->width() ; }
-      bool isConstant() const{}
+      bool isConstant() const
+      {
+	return expr_->isConstant()&&true_->isConstant()&&((false_==NULL)||false_->isConstant());
+      }
+      signed calcConstant() const
+      {
+	if( expr_->calcConstant() )
+	  return true_->calcConstant();
+	else
+	  return (false_!=NULL) ? false_->calcConstant() : 0;
+      }
 
       void toXML(std::ostream& ostr) const;
       void toVerilog(std::ostream& ostr) const;
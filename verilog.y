@@ -39,11 +39,65 @@ extern void lex_end_table();
 moe::Verilog::Module*   module_;
 moe::Verilog::Function* function_;
 moe::Verilog::Instance* instance_;
+static int              gate_;
 
 static void error(char* text)
   {
 //    yyerror(text);
   }
+
+// a primitive logic gate becomes a continuous assignment.
+static void addGate(int type,vector<moe::Verilog::Expression*>* port)
+{
+  moe::Verilog::Expression* expr =NULL;
+  int op;
+  
+  switch( type )
+    {
+    case moe::Verilog::Gate::AND:
+    case moe::Verilog::Gate::NAND:
+      op =moe::Verilog::Expression::BitwiseAND;
+      break;
+    case moe::Verilog::Gate::OR:
+    case moe::Verilog::Gate::NOR:
+      op =moe::Verilog::Expression::BitwiseOR;
+      break;
+    case moe::Verilog::Gate::XOR:
+    case moe::Verilog::Gate::XNOR:
+      op =moe::Verilog::Expression::BitwiseXOR;
+      break;
+    case moe::Verilog::Gate::BUF:
+    case moe::Verilog::Gate::NOT:
+      {
+	unsigned int i;
+	for( i=0;i+1<port->size();i++ )
+	  {
+	    expr =(*port).back()->clone();
+	    if( type==moe::Verilog::Gate::NOT )
+	      expr =new moe::Verilog::Unary( moe::Verilog::Expression::BitwiseNegation,expr );
+	    module_->addAssign( (*port)[i],expr );
+	  }
+      }
+      return;
+    default:
+      error("not supported.");
+      return;
+    }
+  
+  if( port->size()<2 )
+    return;
+  
+  unsigned int i;
+  for( i=1;i<port->size();i++ )
+    expr =(expr==NULL) ? (*port)[i] : new moe::Verilog::Binary( op,expr,(*port)[i] );
+  
+  if( (type==moe::Verilog::Gate::NAND)||
+      (type==moe::Verilog::Gate::NOR)||
+      (type==moe::Verilog::Gate::XNOR) )
+    expr =new moe::Verilog::Unary( moe::Verilog::Expression::BitwiseNegation,expr );
+  
+  module_->addAssign( (*port)[0],expr );
+}
 %}
 
 %union {
@@ -266,7 +320,7 @@ static void error(char* text)
 %type <exprs> range range_opt
 %type <type>  net_type
 %type <type>  v2k_net_type
-%type <type> gatetype
+%type <type> gatetype gate_type
 %type <type> port_type
 %type <exprs> range_or_type_opt
 %type <evexprs> event_expression_list
@@ -781,16 +835,16 @@ func_body K_endfunction
     // delete *i;
   // delete $5;
 }
-| gatetype gate_instance_list ';'
+| gate_type gate_instance_list ';'
 {
 }
-| gatetype drive_strength gate_instance_list ';'
+| gate_type drive_strength gate_instance_list ';'
 {
 }
-| gatetype delay3 gate_instance_list ';'
+| gate_type delay3 gate_instance_list ';'
 {
 }
-| gatetype drive_strength delay3 gate_instance_list ';'
+| gate_type drive_strength delay3 gate_instance_list ';'
 {
 }
 | K_assign error '=' expression ';'
@@ -1948,6 +2002,14 @@ expression
 }
 ;
 
+gate_type
+: gatetype
+{
+  gate_ =$1;
+  $$ =$1;
+}
+;
+
 gatetype
 : K_and  
 {
@@ -2173,11 +2235,13 @@ gate_instance_list
 gate_instance
 : IDENTIFIER '(' expression_list ')'
 {
+  addGate( gate_,$3 );
   // delete $1;
   // delete $3;
 }
 | '(' expression_list ')'
 {
+  addGate( gate_,$2 );
   // delete $2;
 }
 ;